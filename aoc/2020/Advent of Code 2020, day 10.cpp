@@ -3,20 +3,25 @@
 // Godbolt link: https://godbolt.org/z/3dGfzh
 
 #include <algorithm>
+#include <array>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 #include <fmt/core.h>
 
+#include "AoC_input.hpp"
+#include "AoC_pool.hpp"
+#include "AoC_probe.hpp"
+
 std::array<int, 3> count_sorted_diffs(std::vector<int> const& v) {
   auto cpy = v;
   cpy.push_back(0); // charging outlet
   std::sort(begin(cpy), end(cpy));
   std::array<int, 3> res{};
-  for (auto i = 1; i < cpy.size(); ++i) { // adjacent_diff with special inserter
+  for (std::size_t i = 1; i < cpy.size(); ++i) { // adjacent_diff with special inserter
     auto const d = cpy[i] - cpy[i-1];
     //fmt::print("{} to {} is {}. ", cpy[i-1], cpy[i], d);
-    ++res[d - 1];
+    ++res[static_cast<std::size_t>(d - 1)];
     //fmt::print("res is [{}, {}, {}]\n", res[0], res[1], res[2]);
   }
   ++res.back(); // device
@@ -120,7 +125,7 @@ std::size_t count_valid(std::vector<int> const& v) {
 
 //////////////////////////////////////////////////////////////////////
 
-int main() {
+int main(int argc, char* argv[]) {
 
 auto const test = std::vector<int>
 { 16
@@ -274,11 +279,20 @@ auto const input = std::vector<int>
 , 15
 };
 
-auto const diffs = count_sorted_diffs(input);
+auto const adapters = argc > 1 ? aoc::numbers(aoc::input(argc, argv, {})) : input;
+std::array<int, 3> diffs{};
+std::size_t combinations = 0;
+aoc::parallel_invoke(
+  [&] {
+    auto const part = aoc::Probe{"part 1"};
+    diffs = count_sorted_diffs(adapters);
+  },
+  [&] {
+    auto const part = aoc::Probe{"part 2"};
+    combinations = count_paths(adapters);
+  });
 fmt::print("There are {} 1-diffs and {} 3-diffs, product is {}\n",
   diffs.front(), diffs.back(), diffs.front() * diffs.back());
-
-auto const combinations = count_paths(input);
 fmt::print("There are {} valid combinations\n", combinations);
 
 }
\ No newline at end of file
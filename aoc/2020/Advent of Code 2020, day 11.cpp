@@ -9,63 +9,21 @@
 #include <vector>
 #include <fmt/core.h>
 
+#include "AoC_grid.hpp"
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_pool.hpp"
+#include "AoC_probe.hpp"
+
 auto constexpr occupied = '#';
 auto constexpr empty = 'L';
 auto constexpr floor = '.';
 
-template<class T>
-class Matrix
-{
-  std::vector<T> data_;
-  std::size_t cols_;
-public:
-  Matrix(std::size_t rows, std::size_t cols, T const& value)
-  : data_(rows*cols, value)
-  , cols_{cols}
-  { }
- 
-  void add_row(T const& value) {
-    auto const idx = data_.size();
-    data_.resize(data_.size() + cols_);
-    std::fill_n(std::next(begin(data_), idx), cols_, value);
-  }
-
-  template<class It>
-  void add_row(It first, It last) {
-    assert(std::distance(first, last) == cols_);
-    auto const idx = data_.size();
-    data_.resize(data_.size() + cols_);
-    std::copy(first, last, std::next(begin(data_), idx));
-  }
-
-  std::size_t rows() const noexcept { return data_.size() / cols_; }
-  std::size_t cols() const noexcept { return cols_; }
-
-  T at(std::size_t row, std::size_t col) const noexcept {
-    return data_[row*cols_ + col];
-  }
-
-  void set(std::size_t row, std::size_t col, T value) noexcept {
-    data_[idx(row, col)] = std::move(value);
-  }
-
-  std::size_t count(T const& value) const noexcept {
-    return std::count(begin(data_), end(data_), value);
-  }
-
-private:
-  std::size_t idx(std::size_t row, std::size_t col) const noexcept {
-    return row*cols_ + col;
-  }
-  auto iterator(std::size_t row, std::size_t col) const noexcept {
-    return std::next(begin(data_), idx(row, col));
-  }
-
-};
-
-void print(Matrix<char> const& m, std::string_view const at_the_end = "\n") {
-  for (std::size_t i = 0; i < m.rows(); ++i) {
-    for (std::size_t j = 0; j < m.cols(); ++j) {
+void print(aoc::Grid<char> const& m, std::string_view const at_the_end = "\n") {
+  auto const rows = static_cast<std::ptrdiff_t>(m.rows());
+  auto const cols = static_cast<std::ptrdiff_t>(m.cols());
+  for (std::ptrdiff_t i = 0; i < rows; ++i) {
+    for (std::ptrdiff_t j = 0; j < cols; ++j) {
       fmt::print("{}", m.at(i, j));
     }
     fmt::print("\n");
@@ -73,37 +31,42 @@ void print(Matrix<char> const& m, std::string_view const at_the_end = "\n") {
   fmt::print("{}", at_the_end);
 }
 
-Matrix<char> parse(std::string_view s) {
-  auto const n = std::min(s.size(), s.find('\n'));
-  Matrix<char> res(0, n, floor);
-  for (auto it = begin(s); it != end(s); it += n + 1) {
-    res.add_row(it, std::next(it, n));
+// The grid is surrounded by a halo of floor, so that every seat has eight
+// neighbors.
+aoc::Grid<char> parse(std::string_view s) {
+  aoc::Lines const lines{s};
+  auto const cols = (*lines.begin()).size();
+  aoc::Grid<char> res(0, cols, floor, 1);
+  res.reserve(s.size() / (cols + 1) + 1);
+  for (auto const line : lines) {
+    res.add_row(begin(line), end(line));
   }
   return res;
 }
 
 template<class T>
-std::size_t count_neighbor(Matrix<T> const& m, std::size_t i, std::size_t j, T const& value) {
-  auto const R = m.rows()-1;
-  auto const C = m.cols()-1;
-  auto res = 0;
-  if (i > 0 && j > 0) res += m.at(i-1, j-1) == value;
-  if (i > 0         ) res += m.at(i-1, j  ) == value;
-  if (i > 0 && j < C) res += m.at(i-1, j+1) == value;
-  if (         j > 0) res += m.at(i  , j-1) == value;
-  if (         j < C) res += m.at(i  , j+1) == value;
-  if (i < R && j > 0) res += m.at(i+1, j-1) == value;
-  if (i < R         ) res += m.at(i+1, j  ) == value;
-  if (i < R && j < C) res += m.at(i+1, j+1) == value;
+std::size_t count_neighbor(aoc::Grid<T> const& m, std::ptrdiff_t i, std::ptrdiff_t j, T const& value) {
+  assert( m.halo() >= 1 ); // no bound to check
+  std::size_t res = 0;
+  res += m.at(i-1, j-1) == value;
+  res += m.at(i-1, j  ) == value;
+  res += m.at(i-1, j+1) == value;
+  res += m.at(i  , j-1) == value;
+  res += m.at(i  , j+1) == value;
+  res += m.at(i+1, j-1) == value;
+  res += m.at(i+1, j  ) == value;
+  res += m.at(i+1, j+1) == value;
   //fmt::print("({},{}) has {} neighbors {}\n", i, j, res, value);
   return res;
 }
 
-std::size_t evolve_1(Matrix<char>& m) {
-  auto res = 0;
+std::size_t evolve_1(aoc::Grid<char>& m) {
+  std::size_t res = 0;
   auto update = m;
-  for (std::size_t i = 0; i < m.rows(); ++i) {
-    for (std::size_t j = 0; j < m.cols(); ++j) {
+  auto const rows = static_cast<std::ptrdiff_t>(m.rows());
+  auto const cols = static_cast<std::ptrdiff_t>(m.cols());
+  for (std::ptrdiff_t i = 0; i < rows; ++i) {
+    for (std::ptrdiff_t j = 0; j < cols; ++j) {
       switch (m.at(i, j)) {
         case empty: {
           if (count_neighbor(m, i, j, occupied) == 0) {
@@ -130,18 +93,18 @@ std::size_t evolve_1(Matrix<char>& m) {
 }
 
 template<class T>
-bool contains_before_direction(Matrix<T> const& m, T const& value, T const& ignore,
-                               int i, int j, int h_step, int v_step) {
+bool contains_before_direction(aoc::Grid<T> const& m, T const& value, T const& ignore,
+                               std::ptrdiff_t i, std::ptrdiff_t j,
+                               std::ptrdiff_t h_step, std::ptrdiff_t v_step) {
   auto const is_valid = [&](auto const& p) {
-    auto const i = p.first;
-    auto const j = p.second;
-    return 0 <= i && i < m.rows()
-        && 0 <= j && j < m.cols();
+    auto const [r, c] = p;
+    return 0 <= r && r < static_cast<std::ptrdiff_t>(m.rows())
+        && 0 <= c && c < static_cast<std::ptrdiff_t>(m.cols());
   };
-  auto const advance = [&](int& i, int& j) -> std::pair<int, int> {
-    i += h_step;
-    j += v_step;
-    return {i, j};
+  auto const advance = [&](std::ptrdiff_t& r, std::ptrdiff_t& c) -> std::pair<std::ptrdiff_t, std::ptrdiff_t> {
+    r += h_step;
+    c += v_step;
+    return {r, c};
   };
   for (; is_valid(advance(i, j));) {
     auto const v = m.at(i, j);
@@ -152,9 +115,9 @@ bool contains_before_direction(Matrix<T> const& m, T const& value, T const& igno
 }
 
 template<class T>
-std::size_t count_neighbor_ignore(Matrix<T> const& m, std::size_t i, std::size_t j,
+std::size_t count_neighbor_ignore(aoc::Grid<T> const& m, std::ptrdiff_t i, std::ptrdiff_t j,
                                   T const& value, T const& ignore) {
-  auto res = 0;
+  std::size_t res = 0;
   res += contains_before_direction(m, value, ignore, i, j, +1, +0);
   res += contains_before_direction(m, value, ignore, i, j, +1, +1);
   res += contains_before_direction(m, value, ignore, i, j, +0, +1);
@@ -167,11 +130,13 @@ std::size_t count_neighbor_ignore(Matrix<T> const& m, std::size_t i, std::size_t
   return res;
 }
 
-std::size_t evolve_2(Matrix<char>& m) {
-  auto res = 0;
+std::size_t evolve_2(aoc::Grid<char>& m) {
+  std::size_t res = 0;
   auto update = m;
-  for (std::size_t i = 0; i < m.rows(); ++i) {
-    for (std::size_t j = 0; j < m.cols(); ++j) {
+  auto const rows = static_cast<std::ptrdiff_t>(m.rows());
+  auto const cols = static_cast<std::ptrdiff_t>(m.cols());
+  for (std::ptrdiff_t i = 0; i < rows; ++i) {
+    for (std::ptrdiff_t j = 0; j < cols; ++j) {
       switch (m.at(i, j)) {
         case empty: {
           if (count_neighbor_ignore(m, i, j, occupied, floor) == 0) {
@@ -198,15 +163,15 @@ std::size_t evolve_2(Matrix<char>& m) {
 }
 
 template<class Evolution>
-void evolve_until_stable(Matrix<char>& m, Evolution&& e) {
+void evolve_until_stable(aoc::Grid<char>& m, Evolution&& e) {
   for (; e(m) > 0; ) /*print(m)*/;
 }
 
 //////////////////////////////////////////////////////////////////////
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(L.LL.LL.LL
+[[maybe_unused]] auto const test = R"(L.LL.LL.LL
 LLLLLLL.LL
 L.L.L..L..
 LLLL.LL.LL
@@ -319,21 +284,31 @@ LLLLL.LLLLLLLL.LLLLLL.LLLLL.LLLLLLL.LLLLLLLL.LLLLLLLLL.LLLLLLLLL.LLLLLL..L.LLLLL
 LLLLL.LLLLLLLL.LLLLLLLLLL.LLLLLLLLL.LLLL.LLLLLLLL.LLL..LLLLLLLLL.LLLLLLLLL.LLLLLL.LLLLLLLL
 )";
 
-auto const m = parse(input);
+auto const text = aoc::input(argc, argv, input);
+auto probe = aoc::Probe{"parse"};
+auto const m = parse(text);
 fmt::print("m is {} by {} ({} cells)\n",
   m.rows(), m.cols(), m.rows()*m.cols());
 fmt::print("initially it has {} empty, {} occupied, {} floor\n\n",
   m.count(empty), m.count(occupied), m.count(floor));
 //print(m);
 
+probe.stop();
 auto m1 = m;
-evolve_until_stable(m1, evolve_1);
+auto m2 = m;
+aoc::parallel_invoke(
+  [&] {
+    auto const part = aoc::Probe{"part 1"};
+    evolve_until_stable(m1, evolve_1);
+  },
+  [&] {
+    auto const part = aoc::Probe{"part 2"};
+    evolve_until_stable(m2, evolve_2);
+  });
 //print(m1);
 fmt::print("stable #1 has {} empty, {} occupied, {} floor\n\n",
   m1.count(empty), m1.count(occupied), m1.count(floor));
 
-auto m2 = m;
-evolve_until_stable(m2, evolve_2);
 //print(m2);
 fmt::print("stable #2 has {} empty, {} occupied, {} floor\n\n",
   m2.count(empty), m2.count(occupied), m2.count(floor));
@@ -7,29 +7,23 @@
 #include <vector>
 #include <fmt/core.h>
 
-int to_int(std::string_view const s) {
-  int res = 0;
-  for (auto const c : s) {
-    res = res*10 + (c - '0');
-  }
-  return res;
-}
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_probe.hpp"
 
 using Instruction = std::pair<char, int>;
 
 Instruction parse_line(std::string_view const s) {
   auto const c = s.front();
-  auto const i = to_int(s.substr(1)); 
+  auto const i = aoc::to_int(s.substr(1));
   return {c, i};
 }
 
 auto parse(std::string_view text)
 {
   std::vector<Instruction> res;
-  while (!text.empty()) {
-    auto const pos = text.find('\n');
-    res.push_back(parse_line(text.substr(0, pos)));
-    text.remove_prefix(pos+1);
+  for (auto const line : aoc::Lines{text}) {
+    res.push_back(parse_line(line));
   }
   return res;
 }
@@ -67,7 +61,7 @@ void rotate_clockwise(State& state, int degrees) {
   std::array<char, 4> dirs = {'N', 'E', 'S', 'W'};
   auto const cur_idx = std::distance(begin(dirs), std::find(begin(dirs), end(dirs), state.direction));
   auto const idx = (cur_idx + times) % 4;
-  state.direction = dirs[idx];
+  state.direction = dirs[static_cast<std::size_t>(idx)];
 } 
 
 struct Waypoint {
@@ -159,9 +153,9 @@ int manhattan_distance(Position const& lhs, Position const& rhs) {
        + std::abs(lhs.second - rhs.second);
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(F10
+[[maybe_unused]] auto const test = R"(F10
 N3
 F7
 R90
@@ -956,7 +950,10 @@ N2
 F20
 )";
 
-auto const instructions = parse(input);
+auto const text = aoc::input(argc, argv, input);
+auto probe = aoc::Probe{"parse"};
+auto const instructions = parse(text);
+probe.next("part 2");
 
 auto const state = execute(instructions, advance_2);
 auto const d = manhattan_distance(state.pos, {0, 0});
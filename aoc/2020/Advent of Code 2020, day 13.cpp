@@ -12,42 +12,33 @@
 
 #include <numeric>
 
-bool is_digit(char const c) {
-  return '0' <= c && c <= '9';
-}
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_pool.hpp"
+#include "AoC_probe.hpp"
 
 using Int = std::int64_t;
 
-Int to_int(std::string_view const s) {
-  Int res = 0;
-  for (auto const c : s) {
-    res = res*10 + (c - '0');
-  }
-  return res;
-}
-
-std::pair<Int, std::vector<std::pair<Int, Int>>> parse(std::string_view const text)
+std::pair<Int, std::vector<std::pair<Int, Int>>> parse(std::string_view text)
 {
   std::vector<std::pair<Int, Int>> buses;
-  auto it = std::find(begin(text), end(text), '\n');
-  auto const t = to_int({begin(text), it});
-  int xs = 0;
-  while (it != end(text)) {
-    auto const f = std::find_if(it, end(text), is_digit);
-    if (f == end(text)) break;
-    xs += std::count(it, f, 'x');
-    auto const l = std::find_if_not(f, end(text), is_digit);
-    buses.emplace_back(to_int({f, l}),xs++);
-    it = l;
+  auto const t = aoc::to_int<Int>(aoc::fetch_line(text));
+  Int xs = 0;
+  while (!text.empty()) {
+    auto const gap = text;
+    aoc::skip_to_digit(text);
+    if (text.empty()) break;
+    xs += std::count(begin(gap), end(gap) - text.size(), 'x');
+    buses.emplace_back(aoc::fetch_int<Int>(text), xs++);
   }
   return {t, buses};
 }
 
 std::pair<Int, Int> bus_and_earliest_time(Int const t0, std::vector<std::pair<Int, Int>> const& buses) {
-  Int bus;
+  Int bus = 0;
   Int time = INT64_MAX;
-  for (auto const [b, _] : buses) {
-    auto t = 0;
+  for (auto const& [b, _] : buses) {
+    Int t = 0;
     for (; t < t0; t += b);
     if (t < time) {
       bus = b;
@@ -79,7 +70,7 @@ Int align_buses(std::vector<std::pair<Int, Int>> const& buses) {
     return res * bus.first;
   });
   Int res = 0;
-  for (auto const [b, d] : buses) {
+  for (auto const& [b, d] : buses) {
     auto const a = (b - d) % b;
     auto const c = prod / b;
     res += a * c * inv_mod(c, b);
@@ -88,13 +79,13 @@ Int align_buses(std::vector<std::pair<Int, Int>> const& buses) {
   return res % prod;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(939
+[[maybe_unused]] auto const test = R"(939
 7,13,x,x,59,x,31,19
 )";
 
-auto const test2 = R"(0
+[[maybe_unused]] auto const test2 = R"(0
 17,x,13,19
 )";
 
@@ -102,7 +93,9 @@ auto const input = R"(1015292
 19,x,x,x,x,x,x,x,x,41,x,x,x,x,x,x,x,x,x,743,x,x,x,x,x,x,x,x,x,x,x,x,13,17,x,x,x,x,x,x,x,x,x,x,x,x,x,x,29,x,643,x,x,x,x,x,37,x,x,x,x,x,x,x,x,x,x,x,x,x,x,x,x,23
 )";
 
-auto const [t, buses] = parse(input);
+auto const text = aoc::input(argc, argv, input);
+auto probe = aoc::Probe{"parse"};
+auto const [t, buses] = parse(text);
 
 fmt::print("t: {}\nbuses: ", t);
 for (auto [b, _] : buses) {
@@ -114,13 +107,23 @@ for (auto [_, d] : buses) {
   fmt::print("{} ", d);
 }
 
-auto const [b, e] = bus_and_earliest_time(t, buses);
+probe.stop();
+std::pair<Int, Int> earliest;
+Int res2 = 0;
+aoc::parallel_invoke(
+  [&] {
+    auto const part = aoc::Probe{"part 1"};
+    earliest = bus_and_earliest_time(t, buses);
+  },
+  [&] {
+    auto const part = aoc::Probe{"part 2"};
+    res2 = align_buses(buses);
+  });
+auto const [b, e] = earliest;
 fmt::print("\nbus {} arrives at time {}\n", b, e);
 
 auto const res1 = (e - t) * b;
 fmt::print("solution to part 1 is {}\n", res1);
-
-auto const res2 = align_buses(buses);
 fmt::print("solution to part 2 is {}\n", res2);
 
 }
\ No newline at end of file
@@ -4,37 +4,147 @@
 
 #include <algorithm>
 #include <array>
-#include <bitset>
+#include <bit>
 #include <cassert>
 #include <cstdint>
-#include <numeric>
+#include <memory_resource>
 #include <string_view>
-#include <unordered_map>
 #include <utility>
 #include <vector>
 #include <fmt/core.h>
 
-bool is_digit(char const c) {
-  return '0' <= c && c <= '9';
-}
+#include "AoC_arena.hpp"
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_pool.hpp"
+#include "AoC_probe.hpp"
 
-template<class It>
-std::uint64_t to_uint(It first, It const last) {
-  std::uint64_t res = 0;
-  while (first != last) {
-    res = res*10 + (*first++ - '0');
+// Open-addressing hash map from 64-bit keys to 'T', with linear probing over
+// a power-of-two capacity. The key 'FlatMap::empty' is reserved.
+template<class T>
+class FlatMap {
+public:
+  static auto constexpr empty = ~std::uint64_t{0};
+
+private:
+  std::vector<std::uint64_t> keys_;
+  std::vector<T> values_;
+  std::size_t size_ = 0;
+  int shift_ = 64;
+
+  std::size_t slot(std::uint64_t const key) const {
+    return (key * 0x9E3779B97F4A7C15) >> shift_;
   }
-  return res;
-}
 
-std::string_view fetch_line(std::string_view& text) {
-  auto pos = text.find('\n');
-  auto res = text.substr(0, pos);
-  text.remove_prefix(pos+1);
-  return res;
-}
+  void rehash(std::size_t const capacity) {
+    auto keys = std::exchange(keys_, std::vector<std::uint64_t>(capacity, empty));
+    auto values = std::exchange(values_, std::vector<T>(capacity));
+    shift_ = 64 - std::countr_zero(capacity);
+    for (std::size_t i = 0; i < keys.size(); ++i) { // zip
+      if (keys[i] != empty) {
+        auto s = slot(keys[i]);
+        while (keys_[s] != empty) {
+          s = (s + 1) & (capacity - 1);
+        }
+        keys_[s] = keys[i];
+        values_[s] = std::move(values[i]);
+      }
+    }
+  }
+
+public:
+  FlatMap() {
+    rehash(16);
+  }
+
+  std::size_t size() const {
+    return size_;
+  }
+
+  // Make room for 'n' elements without rehashing (load factor of 1/2).
+  void reserve(std::size_t const n) {
+    if (2*n > keys_.size()) {
+      rehash(std::bit_ceil(2*n));
+    }
+  }
+
+  T& operator[](std::uint64_t const key) {
+    assert( key != empty );
+    auto const capacity = keys_.size();
+    auto s = slot(key);
+    while (keys_[s] != key) {
+      if (keys_[s] == empty) {
+        if (2*(size_ + 1) > capacity) {
+          rehash(2*capacity);
+          return (*this)[key];                                       // RETURN
+        }
+        keys_[s] = key;
+        ++size_;
+        break;
+      }
+      s = (s + 1) & (capacity - 1);
+    }
+    return values_[s];
+  }
+
+  template<class F>
+  void for_each(F f) const {
+    for (std::size_t i = 0; i < keys_.size(); ++i) { // zip
+      if (keys_[i] != empty) {
+        f(keys_[i], values_[i]);
+      }
+    }
+  }
+};
+
+// Range of the addresses obtained by setting any subset of the bits of
+// 'floating' in 'base', enumerated in place with 'sub = (sub - mask) & mask'.
+// Bits of 'floating' must be cleared in 'base'.
+class FloatingAddresses {
+  std::uint64_t base_;
+  std::uint64_t floating_;
+public:
+  class iterator {
+    std::uint64_t base_;
+    std::uint64_t floating_;
+    std::uint64_t sub_;
+    bool done_;
+  public:
+    iterator(std::uint64_t base, std::uint64_t floating, bool done)
+      : base_{base}, floating_{floating}, sub_{0}, done_{done} {}
+    std::uint64_t operator*() const {
+      return base_ | sub_;
+    }
+    iterator& operator++() {
+      sub_ = (sub_ - floating_) & floating_;
+      done_ = sub_ == 0;
+      return *this;
+    }
+    bool operator==(iterator const& other) const {
+      return done_ == other.done_ && (done_ || sub_ == other.sub_);
+    }
+    bool operator!=(iterator const& other) const {
+      return !(*this == other);
+    }
+  };
+
+  FloatingAddresses(std::uint64_t const base, std::uint64_t const floating)
+    : base_{base}, floating_{floating} {
+    assert( (base & floating) == 0 );
+  }
+
+  std::size_t size() const {
+    return std::size_t{1} << std::popcount(floating_);
+  }
 
-//////////////////////////////////////////////////////////////////////////
+  iterator begin() const {
+    return {base_, floating_, false};
+  }
+
+  iterator end() const {
+    return {base_, floating_, true};
+  }
+};
 
 class Mask {
 public:
@@ -42,62 +152,42 @@ public:
   std::array<char, N> mask_;
 
   class Protocol1 {
-    std::bitset<N> zero_;
-    std::bitset<N> one_;
+    std::uint64_t zero_ = 0;
+    std::uint64_t one_ = 0;
   public:
     explicit Protocol1(std::array<char, N> mask) {
-      zero_.set();
       for (std::size_t i=0; i < N; ++i) { // enumerate
         auto const c = mask[N - 1 - i];
-        if (c == '0') {
-          zero_.flip(i);
+        if (c != '0') {
+          zero_ |= std::uint64_t{1} << i;
         }
         if (c == '1') {
-          one_.flip(i);
+          one_ |= std::uint64_t{1} << i;
         }
       }
     }
     std::uint64_t apply(std::uint64_t const value) const {
-      auto const res = (std::bitset<N>{value} & zero_) | one_;
-      return res.to_ulong();
+      return (value & zero_) | one_;
     }
   };
 
   class Protocol2 {
-    std::vector<int> ones_;
-    std::vector<int> xs_;
+    std::uint64_t one_ = 0;
+    std::uint64_t x_ = 0;
   public:
     explicit Protocol2(std::array<char, N> mask) {
       for (std::size_t i = 0; i < N; ++i) { // enumerate
         auto const c = mask[N - 1 - i];
         if (c == '1') {
-          ones_.push_back(i);
+          one_ |= std::uint64_t{1} << i;
         }
         if (c == 'x' || c == 'X') {
-          xs_.push_back(i);
+          x_ |= std::uint64_t{1} << i;
         }
       }
     }
-    std::vector<std::uint64_t> apply(std::uint64_t const value) const {
-      auto base = value;
-      for (auto b : ones_) {
-        base |= std::uint64_t{1} << b;
-      }
-      for (auto b : xs_) { // initially all zeros
-        base &= ~(std::uint64_t{1} << b);
-      }
-      //fmt::print("base address from {} [{:036b}] is {}[{:036b}]\n", value, value, base, base);
-      std::vector<std::uint64_t> res(1 << xs_.size(), base);
-      for (std::size_t i = 0; i < xs_.size(); ++i) { // enumerate
-        auto const block = 1 << i;
-        auto const mask = std::uint64_t{1} << xs_[i];
-        for (auto it = begin(res); it != end(res); it += 2*block) {
-          std::for_each(it, std::next(it, block), [&](auto& v) {
-            v |= mask;
-          });
-        }
-      }
-      return res;
+    FloatingAddresses apply(std::uint64_t const value) const {
+      return {(value | one_) & ~x_, x_};
     }
   };
 
@@ -125,37 +215,36 @@ struct Instruction {
   std::uint64_t value;
 };
 
-Instruction get_instruction(std::string_view const line) {
-  auto const f_a = std::find_if(begin(line), end(line), is_digit);
-  auto const l_a = std::find_if_not(f_a, end(line), is_digit);
-  auto const a = to_uint(f_a, l_a);
-  auto const f_v = std::find_if(l_a, end(line), is_digit);
-  auto const l_v = std::find_if_not(f_v, end(line), is_digit);
-  auto const v = to_uint(f_v, l_v);
+Instruction get_instruction(std::string_view line) {
+  auto const a = aoc::fetch_int<std::uint64_t>(line);
+  auto const v = aoc::fetch_int<std::uint64_t>(line);
   return {a, v};
 }
 
-std::pair<Mask, std::vector<Instruction>> parse_block(std::string_view& text) {
+using Block = std::pair<Mask, std::pmr::vector<Instruction>>;
+
+Block parse_block(std::string_view& text, std::pmr::memory_resource* const resource) {
   assert( text.substr(0, 4) == "mask" );
-  auto const m = get_mask(fetch_line(text));
-  std::vector<Instruction> instructions;
+  auto const m = get_mask(aoc::fetch_line(text));
+  std::pmr::vector<Instruction> instructions{resource};
   while (!text.empty() && text.substr(0, 4) != "mask") {
-    instructions.push_back(get_instruction(fetch_line(text)));
+    instructions.push_back(get_instruction(aoc::fetch_line(text)));
   }
-  return {m, instructions};
+  return {m, std::move(instructions)};
 }
 
-std::vector<std::pair<Mask, std::vector<Instruction>>> parse(std::string_view text)
+std::pmr::vector<Block> parse(std::string_view text, std::pmr::memory_resource* const resource)
 {
-  std::vector<std::pair<Mask, std::vector<Instruction>>> res;
+  auto const no_alloc = aoc::NoAllocation{"parse"};
+  std::pmr::vector<Block> res{resource};
   while (!text.empty()) {
-    res.push_back(parse_block(text));
+    res.push_back(parse_block(text, resource));
   }
   return res;
 }
 
-auto get_values_1(std::vector<std::pair<Mask, std::vector<Instruction>>> const& code) {
-  std::unordered_map<std::uint64_t, std::uint64_t> res;
+auto get_values_1(std::pmr::vector<Block> const& code) {
+  FlatMap<std::uint64_t> res;
   for (auto const& [m, instructions] : code) {
     auto const mask = m.protocol1();
     for (auto const& [a, i] : instructions) {
@@ -166,38 +255,41 @@ auto get_values_1(std::vector<std::pair<Mask, std::vector<Instruction>>> const&
   return res;
 }
 
-auto get_values_2(std::vector<std::pair<Mask, std::vector<Instruction>>> const& code) {
-  std::unordered_map<std::uint64_t, std::uint64_t> res;
+auto get_values_2(std::pmr::vector<Block> const& code) {
+  FlatMap<std::uint64_t> res;
   for (auto const& [m, instructions] : code) {
     auto const mask = m.protocol2();
     for (auto const& [a, v] : instructions) {
-      for (auto addr : mask.apply(a)) {
+      auto const addresses = mask.apply(a);
+      res.reserve(res.size() + addresses.size());
+      for (auto addr : addresses) {
         //fmt::print("write {} at address {}\n", v, addr);
         res[addr] = v;
       }
-      
     }
   }
   return res;
 }
 
-std::uint64_t sum(std::unordered_map<std::uint64_t, std::uint64_t> const& values) {
-  return std::accumulate(begin(values), end(values), std::uint64_t{0}, [](std::uint64_t res, auto const& p){
-    return res + p.second;
+std::uint64_t sum(FlatMap<std::uint64_t> const& values) {
+  std::uint64_t res = 0;
+  values.for_each([&](std::uint64_t, std::uint64_t const v) {
+    res += v;
   });
+  return res;
 }
 
 //////////////////////////////////////////////////////////////////////
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(mask = XXXXXXXXXXXXXXXXXXXXXXXXXXXXX1XXXX0X
+[[maybe_unused]] auto const test = R"(mask = XXXXXXXXXXXXXXXXXXXXXXXXXXXXX1XXXX0X
 mem[8] = 11
 mem[7] = 101
 mem[8] = 0
 )";
 
-auto const test2 = R"(mask = 000000000000000000000000000000X1001X
+[[maybe_unused]] auto const test2 = R"(mask = 000000000000000000000000000000X1001X
 mem[42] = 100
 mask = 00000000000000000000000000000000X0XX
 mem[26] = 1
@@ -777,12 +869,23 @@ mem[699] = 147751906
 mem[16648] = 30301
 )";
 
-auto const code = parse(input);
+auto const text = aoc::input(argc, argv, input);
+auto arena = aoc::Arena{};
+auto probe = aoc::Probe{"parse"};
+auto const code = parse(text, &arena);
+probe.stop();
 
-auto const res1 = sum(get_values_1(code));
+std::uint64_t res1 = 0, res2 = 0;
+aoc::parallel_invoke(
+  [&] {
+    auto const part = aoc::Probe{"part 1"};
+    res1 = sum(get_values_1(code));
+  },
+  [&] {
+    auto const part = aoc::Probe{"part 2"};
+    res2 = sum(get_values_2(code));
+  });
 fmt::print("res of part 1 is {}\n", res1);
-
-auto const res2 = sum(get_values_2(code));
 fmt::print("res of part 2 is {}\n", res2);
 
 }
\ No newline at end of file
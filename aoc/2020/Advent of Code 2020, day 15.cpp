@@ -2,11 +2,33 @@
 
 // Godbolt link: https://godbolt.org/z/v3b83z
 
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <optional>
+#include <string_view>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 #include <fmt/core.h>
 
+#include "AoC_alloc.hpp"
+#include "AoC_input.hpp"
+#include "AoC_pool.hpp"
+#include "AoC_probe.hpp"
+
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#define AOC_HAS_MMAP 1
+#endif
+
 auto setup(std::vector<int> const& starting) {
   std::unordered_map<int, std::pair<std::size_t /*2nd-to-last*/, std::size_t /*last*/>> res;
   for (std::size_t i=0; i<starting.size(); ++i) { // enumerate
@@ -20,7 +42,7 @@ int spoken_number(std::size_t const n, std::vector<int> const& starting) {
   auto last = starting.back();
   for (auto i = starting.size(); i < n; ++i) {
     auto const [p, l] = memo[last];
-    last = l - p; // conveniently 0 if 'l == p', that is spoken only once
+    last = static_cast<int>(l - p); // conveniently 0 if 'l == p', that is spoken only once
     //fmt::print("{}. {}\n", i, last);
     if (memo.contains(last)) {
         memo[last] = {memo[last].second, i};
@@ -34,14 +56,272 @@ int spoken_number(std::size_t const n, std::vector<int> const& starting) {
 
 //////////////////////////////////////////////////////////////////////
 
-int main() {
+enum class Backing { heap, mmap };
 
-auto const test = {0, 3, 6};
+// Zero-initialized array of 'uint32_t'. With 'Backing::mmap' the memory is an
+// anonymous mapping (asking for transparent huge pages), so that pages which
+// are never touched are never committed. Falls back to the heap if mapping is
+// not available.
+class TurnTable {
+  std::uint32_t* data_ = nullptr;
+  std::size_t size_ = 0;
+  bool mapped_ = false;
+public:
+  TurnTable(std::size_t const size, Backing const backing) : size_{size} {
+#ifdef AOC_HAS_MMAP
+    if (backing == Backing::mmap) {
+      auto const p = ::mmap(nullptr, size_ * sizeof(std::uint32_t),
+                            PROT_READ | PROT_WRITE,
+                            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+      if (p != MAP_FAILED) {
+#ifdef MADV_HUGEPAGE
+        ::madvise(p, size_ * sizeof(std::uint32_t), MADV_HUGEPAGE);
+#endif
+        data_ = static_cast<std::uint32_t*>(p);
+        mapped_ = true;
+        return;                                                      // RETURN
+      }
+    }
+#else
+    static_cast<void>(backing);
+#endif
+    data_ = static_cast<std::uint32_t*>(std::calloc(size_, sizeof(std::uint32_t)));
+    if (!data_) {
+      throw std::bad_alloc{};
+    }
+  }
+
+  TurnTable(TurnTable const&) = delete;
+  TurnTable& operator=(TurnTable const&) = delete;
+
+  ~TurnTable() {
+#ifdef AOC_HAS_MMAP
+    if (mapped_) {
+      ::munmap(data_, size_ * sizeof(std::uint32_t));
+      return;                                                        // RETURN
+    }
+#endif
+    std::free(data_);
+  }
 
-auto const input = {1, 20, 11, 6, 12, 0};
+  std::uint32_t& operator[](std::size_t const i) {
+    assert( i < size_ );
+    return data_[i];
+  }
+};
+
+// Van Eck sequence engine keeping, for every value, the 1-based turn it was
+// last spoken (0 if never). Values below 'small_limit' are by far the most
+// frequent, so they get their own compact table which stays in L1/L2; the
+// large table only ever sees the sparse high values.
+class VanEck {
+  static auto constexpr small_limit = std::uint32_t{1} << 16;
+  std::vector<std::uint32_t> small_;
+  TurnTable large_;
+
+  std::uint32_t& last_seen(std::uint32_t const value) {
+    return value < small_limit ? small_[value] : large_[value];
+  }
+
+public:
+  // Prepare for sequences of up to 'n' turns.
+  VanEck(std::size_t const n, Backing const backing)
+    : small_(small_limit), large_{std::max<std::size_t>(n, small_limit), backing} {
+    assert( n <= std::numeric_limits<std::uint32_t>::max() );
+  }
+
+  // Return the 'n'-th spoken number starting with 'starting'. All starting
+  // numbers must be lower than the 'n' this engine was prepared for.
+  std::uint32_t spoken_number(std::uint32_t const n, std::vector<int> const& starting) {
+    assert( 0 < n && !starting.empty() );
+    auto const k = static_cast<std::uint32_t>(starting.size());
+    if (n <= k) {
+      return static_cast<std::uint32_t>(starting[n - 1]);            // RETURN
+    }
+    for (std::uint32_t i = 0; i + 1 < k; ++i) {
+      last_seen(static_cast<std::uint32_t>(starting[i])) = i + 1;
+    }
+    auto last = static_cast<std::uint32_t>(starting.back());
+    for (auto turn = k; turn < n; ++turn) { // 'last' was spoken at 'turn'
+      auto& seen = last_seen(last);
+      auto const next = seen == 0 ? 0 : turn - seen;
+      seen = turn;
+      last = next;
+    }
+    return last;
+  }
+};
+
+std::uint32_t spoken_number_dense(std::uint32_t const n, std::vector<int> const& starting,
+                                  Backing const backing = Backing::heap) {
+  auto const max = *std::max_element(begin(starting), end(starting));
+  VanEck engine{std::max<std::size_t>(n, static_cast<std::size_t>(max) + 1), backing};
+  auto const no_alloc = aoc::NoAllocation{"VanEck::spoken_number"};
+  return engine.spoken_number(n, starting);
+}
+
+// Fixed-width unsigned integers of 'bits' bits each, packed back to back.
+class PackedArray {
+  std::vector<unsigned char> bytes_;
+  std::size_t bits_;
+  std::uint64_t mask_;
+
+  static std::uint64_t load(unsigned char const* p) {
+    std::uint64_t res;
+    std::memcpy(&res, p, sizeof(res));
+    return res;
+  }
+
+  static void store(unsigned char* p, std::uint64_t const v) {
+    std::memcpy(p, &v, sizeof(v));
+  }
+
+public:
+  PackedArray(std::size_t const size, int const bits)
+    : bytes_((size * static_cast<std::size_t>(bits) + 7) / 8 + sizeof(std::uint64_t)),
+      bits_{static_cast<std::size_t>(bits)},
+      mask_{(std::uint64_t{1} << bits) - 1} {
+    assert( 0 < bits && bits <= 56 );
+  }
+
+  std::size_t bytes() const {
+    return bytes_.size();
+  }
+
+  std::uint64_t get(std::size_t const i) const {
+    auto const bit = i * bits_;
+    return (load(&bytes_[bit / 8]) >> (bit % 8)) & mask_;
+  }
 
+  void set(std::size_t const i, std::uint64_t const v) {
+    auto const bit = i * bits_;
+    auto const shift = bit % 8;
+    auto const word = load(&bytes_[bit / 8]);
+    store(&bytes_[bit / 8], (word & ~(mask_ << shift)) | ((v & mask_) << shift));
+  }
+};
+
+// Van Eck sequence engine trading some CPU for memory: turns are stored in
+// 'bit_width(n - 1)' bits per slot for values below 'dense_limit', while the
+// values above (rare, and nearly always spoken only once) live in a sparse
+// overflow map.
+class CompactVanEck {
+  PackedArray dense_;
+  std::uint32_t dense_limit_;
+  std::unordered_map<std::uint32_t, std::uint32_t> overflow_;
+
+  std::uint32_t exchange(std::uint32_t const value, std::uint32_t const turn) {
+    if (value < dense_limit_) {
+      auto const res = static_cast<std::uint32_t>(dense_.get(value));
+      dense_.set(value, turn);
+      return res;                                                    // RETURN
+    }
+    auto const [it, inserted] = overflow_.try_emplace(value, turn);
+    return inserted ? 0 : std::exchange(it->second, turn);
+  }
+
+public:
+  // Prepare for sequences of up to 'n' turns, keeping values below
+  // 'dense_limit' in the packed table.
+  CompactVanEck(std::size_t const n, std::size_t const dense_limit)
+    : dense_{dense_limit, std::max(1, static_cast<int>(std::bit_width(n - 1)))},
+      dense_limit_{static_cast<std::uint32_t>(dense_limit)} {
+    assert( 0 < n && n <= std::numeric_limits<std::uint32_t>::max() );
+  }
+
+  std::size_t bytes() const {
+    return dense_.bytes()
+      + overflow_.size() * (sizeof(std::pair<std::uint32_t, std::uint32_t>) + 2*sizeof(void*));
+  }
+
+  // Return the 'n'-th spoken number starting with 'starting'.
+  std::uint32_t spoken_number(std::uint32_t const n, std::vector<int> const& starting) {
+    assert( 0 < n && !starting.empty() );
+    auto const k = static_cast<std::uint32_t>(starting.size());
+    if (n <= k) {
+      return static_cast<std::uint32_t>(starting[n - 1]);            // RETURN
+    }
+    for (std::uint32_t i = 0; i + 1 < k; ++i) {
+      exchange(static_cast<std::uint32_t>(starting[i]), i + 1);
+    }
+    auto last = static_cast<std::uint32_t>(starting.back());
+    for (auto turn = k; turn < n; ++turn) { // 'last' was spoken at 'turn'
+      auto const seen = exchange(last, turn);
+      last = seen == 0 ? 0 : turn - seen;
+    }
+    return last;
+  }
+};
+
+std::uint32_t spoken_number_compact(std::uint32_t const n, std::vector<int> const& starting) {
+  CompactVanEck engine{n, n / 2}; // measured best: the upper half is sparse
+  return engine.spoken_number(n, starting);
+}
+
+enum class Engine { dense, dense_mmap, compact };
+
+// Return the number of turns written in 's', if from 1 to 'UINT32_MAX'.
+std::optional<std::uint32_t> parse_turns(char const* const s) {
+  char* end = nullptr;
+  errno = 0;
+  auto const n = std::strtoull(s, &end, 10);
+  if (end == s || *end != '\0' || errno != 0 || *s == '-'
+   || n == 0 || n > std::numeric_limits<std::uint32_t>::max()) {
+    return std::nullopt;                                             // RETURN
+  }
+  return static_cast<std::uint32_t>(n);
+}
+
+// Usage: 'day15 bench <turns> [mmap|compact]' reports the time per turn,
+// 'turns' being from 1 to 'UINT32_MAX'.
+int bench(std::uint32_t const n, std::vector<int> const& starting, Engine const engine) {
+  assert( n > 0 );
+  auto const start = std::chrono::steady_clock::now();
+  auto const res = engine == Engine::compact ? spoken_number_compact(n, starting)
+    : spoken_number_dense(n, starting, engine == Engine::dense_mmap ? Backing::mmap : Backing::heap);
+  auto const stop = std::chrono::steady_clock::now();
+  auto const ns = std::chrono::duration<double, std::nano>(stop - start).count();
+  fmt::print("the {}-th spoken number is {}\n", n, res);
+  fmt::print("{:.3f} ns/turn ({:.3f} s total)\n", ns / n, ns * 1e-9);
+  return 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[]) {
+
+[[maybe_unused]] auto const test = {0, 3, 6};
+
+auto const input = std::vector{1, 20, 11, 6, 12, 0};
+
+if (argc > 2 && std::string_view{argv[1]} == "bench") {
+  auto const n = parse_turns(argv[2]);
+  auto const mode = argc > 3 ? std::string_view{argv[3]} : std::string_view{};
+  if (!n || argc > 4 || !(mode.empty() || mode == "mmap" || mode == "compact")) {
+    fmt::print(stderr, "usage: {} bench <turns> [mmap|compact], turns from 1 to {}\n",
+               argv[0], std::numeric_limits<std::uint32_t>::max());
+    return 1;
+  }
+  auto const engine = mode == "mmap" ? Engine::dense_mmap
+    : mode == "compact" ? Engine::compact : Engine::dense;
+  return bench(*n, input, engine);
+}
+
+auto const starting = argc > 1 ? aoc::numbers(aoc::input(argc, argv, {})) : input;
 auto const n = 2020;
-auto const res = spoken_number(n, input);
+auto const n2 = 30'000'000;
+int res = 0;
+std::uint32_t res2 = 0;
+aoc::parallel_invoke(
+  [&] {
+    auto const part = aoc::Probe{"part 1"};
+    res = spoken_number(n, starting);
+  },
+  [&] {
+    auto const part = aoc::Probe{"part 2"};
+    res2 = spoken_number_dense(n2, starting);
+  });
 fmt::print("(1) the {}-th spoken number is {}\n", n, res);
+fmt::print("(2) the {}-th spoken number is {}\n", n2, res2);
 
-}
\ No newline at end of file
+}
@@ -4,49 +4,22 @@
 
 #include <algorithm>
 #include <cstdint>
+#include <limits>
+#include <memory_resource>
 #include <numeric>
+#include <optional>
 #include <string_view>
 #include <unordered_map>
-#include <unordered_set>
 #include <tuple>
+#include <utility>
 #include <vector>
 #include <fmt/core.h>
 
-bool is_digit(char const c) {
-  return '0' <= c && c <= '9';
-}
-
-template<class It>
-int to_int(It first, It const last) {
-  int res = 0;
-  while (first != last) {
-    res = res*10 + (*first++ - '0');
-  }
-  return res;
-}
-
-std::string_view fetch_line(std::string_view& text) {
-  auto const pos = text.find('\n');
-  auto res = text.substr(0, pos);
-  text.remove_prefix(pos+1);
-  return res;
-}
-
-void skip_to_digit(std::string_view& text) {
-  auto const it = std::find_if(begin(text), end(text), is_digit);
-  auto const pos = std::distance(begin(text), it);
-  text.remove_prefix(pos);
-}
-
-int fetch_int_nosign(std::string_view& text) {
-  skip_to_digit(text);
-  auto const last = std::find_if_not(begin(text), end(text), is_digit);
-  auto res = to_int(begin(text), last);
-  text.remove_prefix(std::distance(begin(text), last));
-  return res;
-}
-
-//////////////////////////////////////////////////////////////////////////
+#include "AoC_arena.hpp"
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_pool.hpp"
+#include "AoC_probe.hpp"
 
 struct Interval // [lhs, rhs]
 {
@@ -55,8 +28,9 @@ struct Interval // [lhs, rhs]
 };
 
 class IntervalSet {
-  std::vector<Interval> intervals_;
+  std::pmr::vector<Interval> intervals_;
 public:
+  explicit IntervalSet(std::pmr::memory_resource* const resource) : intervals_{resource} {}
   void add(Interval interval) {
     intervals_.push_back(interval);
   }
@@ -65,200 +39,356 @@ public:
       return interval.lhs <= i && i <= interval.rhs;
     });
   }
+  std::pmr::vector<Interval> const& intervals() const {
+    return intervals_;
+  }
 };
 
-using Rules = std::unordered_map<std::string, IntervalSet>;
+using Rules = std::pmr::unordered_map<std::pmr::string, IntervalSet>;
 
-auto get_field(std::string_view line)
+auto get_field(std::string_view line, std::pmr::memory_resource* const resource)
 {
   auto const colon = line.find(':');
-  std::string name(begin(line), std::next(begin(line), colon));
-  IntervalSet intervals;
+  std::pmr::string name(line.substr(0, colon), resource);
+  IntervalSet intervals{resource};
   while (!line.empty()) {
-    auto const lhs = fetch_int_nosign(line);
+    auto const lhs = aoc::fetch_int(line);
     auto const rhs = !line.empty() && line.front() == '-'
-                   ? fetch_int_nosign(line) : lhs;
+                   ? aoc::fetch_int(line) : lhs;
     intervals.add({lhs, rhs});
   }
-  return std::pair{name, intervals};
+  return std::pair{std::move(name), std::move(intervals)};
 }
 
-auto parse_fields(std::string_view& text)
+auto parse_fields(std::string_view& text, std::pmr::memory_resource* const resource)
 {
-  Rules res;
-  for(auto line = fetch_line(text);
+  Rules res{resource};
+  for(auto line = aoc::fetch_line(text);
       !text.empty() && !line.empty();
-      line = fetch_line(text)) {
-    res.insert(get_field(line));
+      line = aoc::fetch_line(text)) {
+    res.insert(get_field(line, resource));
   }  
   return res;
 }
 
 struct Ticket {
-  std::vector<int> values;
+  std::pmr::vector<int> values;
 };
 
-Ticket parse_ticket(std::string_view line) {
-  Ticket res;
+Ticket parse_ticket(std::string_view line, std::pmr::memory_resource* const resource) {
+  Ticket res{std::pmr::vector<int>{resource}};
   while (!line.empty()) {
-    res.values.push_back(fetch_int_nosign(line));
+    res.values.push_back(aoc::fetch_int(line));
   }
   return res;
 }
 
-auto parse(std::string_view text)
+auto parse(std::string_view text, std::pmr::memory_resource* const resource)
 {
-  auto const fields = parse_fields(text);
-  skip_to_digit(text);
-  auto const ticket = parse_ticket(fetch_line(text));
-  skip_to_digit(text);
-  std::vector<Ticket> nearby;
-  while (!text.empty()) {
-    nearby.push_back(parse_ticket(fetch_line(text)));
+  auto const no_alloc = aoc::NoAllocation{"parse"};
+  auto fields = parse_fields(text, resource);
+  aoc::skip_to_digit(text);
+  auto ticket = parse_ticket(aoc::fetch_line(text), resource);
+  aoc::skip_to_digit(text);
+  std::pmr::vector<Ticket> nearby{resource};
+  for (auto const line : aoc::Lines{text}) {
+    nearby.push_back(parse_ticket(line, resource));
   }
-  return std::tuple{fields, ticket, nearby};
+  return std::tuple{std::move(fields), std::move(ticket), std::move(nearby)};
 }
 
-int error_rate(Ticket const& ticket, Rules const& rules) {
-  int res = 0;
-  for (auto v : ticket.values) { // accumulate
-    if (std::none_of(begin(rules), end(rules), [&](auto const& p){
-      return p.second.contains(v);
-    })) {
-      res += v;
+// Rules precompiled into a table mapping every value of the bounded domain
+// to the set of fields accepting it, one bit per field ('words()' 64-bit words
+// per value). Bit 'i' stands for the field 'names()[i]'.
+class Validator {
+  std::vector<std::string> names_;
+  std::size_t words_;
+  std::vector<std::uint8_t> valid_;
+  std::vector<std::uint64_t> fields_;
+public:
+  explicit Validator(Rules const& rules) : words_{(rules.size() + 63) / 64} {
+    int domain = 0;
+    for (auto const& [name, intervals] : rules) {
+      for (auto const& [lhs, rhs] : intervals.intervals()) {
+        domain = std::max(domain, rhs + 1);
+      }
+    }
+    valid_.resize(static_cast<std::size_t>(domain));
+    fields_.resize(static_cast<std::size_t>(domain) * words_);
+    for (auto const& [name, intervals] : rules) {
+      auto const bit = names_.size();
+      names_.emplace_back(name);
+      for (auto const& [lhs, rhs] : intervals.intervals()) {
+        for (auto v = std::max(lhs, 0); v <= rhs; ++v) {
+          valid_[static_cast<std::size_t>(v)] = 1;
+          fields_[static_cast<std::size_t>(v) * words_ + bit / 64] |= std::uint64_t{1} << (bit % 64);
+        }
+      }
     }
   }
-  return res;
-}
 
-int total_error_rate(std::vector<Ticket> const& tickets, Rules const& rules) {
-  int res = 0;
-  for (auto const& t : tickets) { // accumulate
-    res += error_rate(t, rules);
+  std::vector<std::string> const& names() const {
+    return names_;
   }
-  return res;
-}
 
-bool is_invalid(int const value, Rules const& rules) {
-  return std::none_of(begin(rules), end(rules), [&](auto const& p) {
-    return p.second.contains(value);
-  });
-}
+  std::size_t words() const {
+    return words_;
+  }
 
-bool is_invalid(Ticket const& ticket, Rules const& rules) {
-  return std::any_of(begin(ticket.values), end(ticket.values), [&](int const v) {
-    return is_invalid(v, rules);
-  });
-}
+  bool is_valid(int const value) const {
+    return static_cast<std::size_t>(value) < valid_.size() && valid_[static_cast<std::size_t>(value)];
+  }
 
-std::size_t remove_invalid(std::vector<Ticket>& tickets, Rules const& rules) {
-  auto const invalid_ticket = [&](Ticket const& ticket) {
-    return is_invalid(ticket, rules);
-  };
-  auto const n = tickets.size();
-  tickets.erase(std::remove_if(begin(tickets), end(tickets), invalid_ticket), end(tickets));
-  return n - tickets.size();
-}
+  // Return the 'words()' words of the set of fields accepting 'value', which
+  // must be valid.
+  std::uint64_t const* fields(int const value) const {
+    return &fields_[static_cast<std::size_t>(value) * words_];
+  }
 
-class Possibilities {
-  std::unordered_map<std::string, std::unordered_set<std::size_t>> field_to_idx_;
-  std::unordered_set<std::string> fields_to_solve_;
-  std::unordered_set<std::size_t> indexes_to_solve_;
-public:
-  explicit Possibilities(Rules const& rules) {
-    auto const n = rules.size();
-    auto const indexes = [&] {
-      std::unordered_set<std::size_t> res;
-      for (std::size_t i=0; i < n; ++i) {
-        res.insert(i);  
+  // Return whether 'ticket' has a valid value for every field.
+  bool is_valid(Ticket const& ticket) const {
+    return ticket.values.size() == names_.size()
+        && std::all_of(begin(ticket.values), end(ticket.values), [&](int const v) {
+             return is_valid(v);
+           });
+  }
+
+  int error_rate(Ticket const& ticket) const {
+    int res = 0;
+    for (auto v : ticket.values) { // accumulate
+      if (!is_valid(v)) {
+        res += v;
       }
-      return res;
-    }(); // IIFE
-    indexes_to_solve_ = indexes;
-    for (auto const& p : rules) {
-      field_to_idx_.emplace(p.first, indexes);
-      fields_to_solve_.insert(p.first);
     }
+    return res;
   }
+};
 
-  void remove(std::size_t idx, std::string const& field) {
-    field_to_idx_.at(field).erase(idx);
+int total_error_rate(std::pmr::vector<Ticket> const& tickets, Validator const& validator) {
+  int res = 0;
+  for (auto const& t : tickets) { // accumulate
+    res += validator.error_rate(t);
   }
+  return res;
+}
 
-  void simplify() {
-    simplify_by_field();
-    simplify_by_idx();
+// Return, for every column, the set of fields accepting the values of all
+// valid 'tickets' in that column ('validator.words()' words per column).
+std::vector<std::uint64_t> candidates(std::pmr::vector<Ticket> const& tickets, Validator const& validator) {
+  auto const words = validator.words();
+  auto const columns = validator.names().size();
+  std::vector<std::uint64_t> res(columns * words, ~std::uint64_t{0});
+  for (auto const& t : tickets) {
+    if (!validator.is_valid(t)) {
+      continue;                                                    // CONTINUE
+    }
+    for (std::size_t i = 0; i < columns; ++i) { // zip
+      auto const fields = validator.fields(t.values[i]);
+      for (std::size_t w = 0; w < words; ++w) {
+        res[i * words + w] &= fields[w];
+      }
+    }
+  }
+  return res;
+}
+
+// Assignment of columns to fields, given per-column candidate sets of fields
+// as bitmasks ('words' 64-bit words per column). Forced choices are made by
+// singleton propagation; whatever is left when propagation stalls is matched
+// with Hopcroft-Karp, so that ambiguous inputs still get a valid assignment.
+// Without a perfect matching, some columns are left unassigned.
+class FieldResolver {
+public:
+  static auto constexpr none = ~std::size_t{0};
+
+private:
+  std::size_t n_;
+  std::size_t words_;
+  std::vector<std::uint64_t> candidates_;
+  std::vector<int> column_count_;
+  std::vector<int> field_count_;
+  std::vector<std::size_t> field_of_;  // by column
+  std::vector<std::size_t> column_of_; // by field
+  std::vector<std::pair<bool /*is_column*/, std::size_t>> queue_;
+
+  bool has(std::size_t const c, std::size_t const f) const {
+    return candidates_[c * words_ + f / 64] >> (f % 64) & 1;
   }
 
-  bool is_unique() const {
-    return fields_to_solve_.empty();
+  void erase(std::size_t const c, std::size_t const f) {
+    candidates_[c * words_ + f / 64] &= ~(std::uint64_t{1} << (f % 64));
+    if (--column_count_[c] == 1) {
+      queue_.emplace_back(true, c);
+    }
+    if (--field_count_[f] == 1) {
+      queue_.emplace_back(false, f);
+    }
   }
 
-  auto solution() const {
-    std::unordered_map<std::string, std::size_t> res;
-    if (is_unique()) {
-      for (auto const& [f, idx] : field_to_idx_) {
-        res.emplace(f, *begin(idx));
+  void assign(std::size_t const c, std::size_t const f) {
+    field_of_[c] = f;
+    column_of_[f] = c;
+    for (std::size_t i = 0; i < n_; ++i) {
+      if (i != c && has(i, f)) {
+        erase(i, f);
+      }
+      if (i != f && has(c, i)) {
+        erase(c, i);
       }
     }
-    return res;
   }
 
-private:
-  void simplify_by_field() {
-    for (auto const& [field, indexes] : field_to_idx_) {
-      if (indexes.size() == 1) {
-        fields_to_solve_.erase(field);
-        auto const idx = *begin(indexes);
-        for (auto const& f : fields_to_solve_) {
-          remove(idx, f);
+  void propagate() {
+    for (std::size_t c = 0; c < n_; ++c) {
+      for (std::size_t f = 0; f < n_; ++f) {
+        if (has(c, f)) {
+          ++column_count_[c];
+          ++field_count_[f];
         }
       }
     }
-  }
-  void simplify_by_idx() {
-    for (std::size_t idx = 0; idx < field_to_idx_.size(); ++idx) {
-      if (std::count_if(begin(field_to_idx_), end(field_to_idx_), [&](auto const& p) {
-                        return p.second.contains(idx);
-        }) == 1) {
-        indexes_to_solve_.erase(idx);
-        auto const it = std::find_if(begin(field_to_idx_), end(field_to_idx_), [&](auto const& p) {
-                        return p.second.contains(idx);
-        });
-        for (auto const& i : indexes_to_solve_) {
-          remove(i, it->first);
+    for (std::size_t i = 0; i < n_; ++i) {
+      if (column_count_[i] == 1) {
+        queue_.emplace_back(true, i);
+      }
+      if (field_count_[i] == 1) {
+        queue_.emplace_back(false, i);
+      }
+    }
+    while (!queue_.empty()) {
+      auto const [is_column, i] = queue_.back();
+      queue_.pop_back();
+      if (is_column && field_of_[i] == none && column_count_[i] == 1) {
+        auto f = std::size_t{0};
+        while (!has(i, f)) {
+          ++f;
         }
+        assign(i, f);
+      }
+      if (!is_column && column_of_[i] == none && field_count_[i] == 1) {
+        auto c = std::size_t{0};
+        while (!has(c, i)) {
+          ++c;
+        }
+        assign(c, i);
       }
     }
   }
-};
 
-auto match(std::vector<Ticket>const& tickets, Rules const& rules) {
-  auto ticks = tickets;
-  remove_invalid(ticks, rules);
-  auto p = Possibilities(rules);
-  for (auto const& t : ticks) {
-    for (std::size_t i=0; i < t.values.size(); ++i) { // enumerate
-      auto const v = t.values[i];
-      for (auto const& [f, intervals] : rules) {
-        if (!intervals.contains(v)) {
-          p.remove(i, f);
+  void hopcroft_karp() {
+    std::vector<std::size_t> columns;
+    std::vector<std::vector<std::size_t>> adjacent(n_);
+    for (std::size_t c = 0; c < n_; ++c) {
+      if (field_of_[c] == none) {
+        columns.push_back(c);
+        for (std::size_t f = 0; f < n_; ++f) {
+          if (column_of_[f] == none && has(c, f)) {
+            adjacent[c].push_back(f);
+          }
+        }
+      }
+    }
+    auto const infinity = std::numeric_limits<std::size_t>::max();
+    std::vector<std::size_t> distance(n_);
+    auto const bfs = [&] {
+      std::vector<std::size_t> frontier;
+      for (auto c : columns) {
+        distance[c] = field_of_[c] == none ? 0 : infinity;
+        if (field_of_[c] == none) {
+          frontier.push_back(c);
+        }
+      }
+      bool found = false;
+      for (std::size_t i = 0; i < frontier.size(); ++i) {
+        auto const c = frontier[i];
+        for (auto f : adjacent[c]) {
+          auto const next = column_of_[f];
+          if (next == none) {
+            found = true;
+          }
+          else if (distance[next] == infinity) {
+            distance[next] = distance[c] + 1;
+            frontier.push_back(next);
+          }
+        }
+      }
+      return found;
+    };
+    auto const dfs = [&](auto const& self, std::size_t const c) -> bool {
+      for (auto f : adjacent[c]) {
+        auto const next = column_of_[f];
+        if (next == none || (distance[next] == distance[c] + 1 && self(self, next))) {
+          field_of_[c] = f;
+          column_of_[f] = c;
+          return true;                                               // RETURN
+        }
+      }
+      distance[c] = infinity;
+      return false;
+    };
+    while (bfs()) {
+      for (auto c : columns) {
+        if (field_of_[c] == none) {
+          dfs(dfs, c);
         }
       }
     }
   }
-  while (!p.is_unique()) {
-    p.simplify();
+
+public:
+  FieldResolver(std::vector<std::uint64_t> candidates, std::size_t const n, std::size_t const words)
+    : n_{n}, words_{words}, candidates_{std::move(candidates)},
+      column_count_(n), field_count_(n), field_of_(n, none), column_of_(n, none) {
+    propagate();
+    hopcroft_karp();
+  }
+
+  // Return whether every column is assigned a field.
+  bool complete() const {
+    return std::none_of(begin(field_of_), end(field_of_), [](std::size_t const f) {
+      return f == none;
+    });
   }
-  return p.solution();
+
+  // Return the field assigned to column 'c', or 'none' if it is left out of
+  // the maximum matching.
+  std::size_t field(std::size_t const c) const {
+    return field_of_[c];
+  }
+};
+
+// Return the column of every field, or nothing if the columns cannot all be
+// assigned a field.
+std::optional<std::unordered_map<std::string, std::size_t>> match(std::pmr::vector<Ticket> const& tickets,
+                                                                   Validator const& validator) {
+  auto const& names = validator.names();
+  FieldResolver const resolver{candidates(tickets, validator), names.size(), validator.words()};
+  if (!resolver.complete()) {
+    return std::nullopt;                                             // RETURN
+  }
+  std::unordered_map<std::string, std::size_t> res;
+  for (std::size_t c = 0; c < names.size(); ++c) {
+    res.emplace(names[resolver.field(c)], c);
+  }
+  return res;
 }
 
 using SolvedTicket = std::unordered_map<std::string, int>;
 
-auto solve(Ticket const& ticket, Rules const& rules, std::vector<Ticket>const& tickets) {
-  auto const solver = match(tickets, rules);
+// Return the value of every field of 'ticket', or nothing if it has not a
+// value per field or the fields cannot all be told apart.
+std::optional<SolvedTicket> solve(Ticket const& ticket, Rules const& rules,
+                                  std::pmr::vector<Ticket> const& tickets) {
+  Validator const validator{rules};
+  if (ticket.values.size() != validator.names().size()) {
+    return std::nullopt;                                             // RETURN
+  }
+  auto const columns = match(tickets, validator);
+  if (!columns) {
+    return std::nullopt;                                             // RETURN
+  }
   SolvedTicket res;
-  for (auto const& [field, idx] : solver) {
+  for (auto const& [field, idx] : *columns) {
     res.emplace(field, ticket.values[idx]);
   }
   return res;
@@ -276,9 +406,9 @@ std::int64_t product_start(SolvedTicket const& ticket, std::string_view const s)
 
 //////////////////////////////////////////////////////////////////////
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(class: 1-3 or 5-7
+[[maybe_unused]] auto const test = R"(class: 1-3 or 5-7
 row: 6-11 or 33-44
 seat: 13-40 or 45-50
 
@@ -292,7 +422,7 @@ nearby tickets:
 38,6,12
 )";
 
-auto const test2 = R"(class: 0-1 or 4-19
+[[maybe_unused]] auto const test2 = R"(class: 0-1 or 4-19
 row: 0-5 or 8-19
 seat: 0-13 or 16-19
 
@@ -569,16 +699,33 @@ nearby tickets:
 729,389,377,642,261,468,74,377,133,206,313,634,652,156,256,641,175,291,355,319
 )";
 
-auto const [fields, ticket, nearby] = parse(input);
-
-auto const res1 = total_error_rate(nearby, fields);
+auto const text = aoc::input(argc, argv, input);
+auto arena = aoc::Arena{};
+auto probe = aoc::Probe{"parse"};
+auto const [fields, ticket, nearby] = parse(text, &arena);
+probe.stop();
+
+int res1 = 0;
+std::optional<SolvedTicket> t;
+aoc::parallel_invoke(
+  [&] {
+    auto const part = aoc::Probe{"part 1"};
+    res1 = total_error_rate(nearby, Validator{fields});
+  },
+  [&] {
+    auto const part = aoc::Probe{"part 2"};
+    t = solve(ticket, fields, nearby);
+  });
 fmt::print("ticket scanning error rate is {}\n", res1);
 
-auto const t = solve(ticket, fields, nearby);
-for (auto const& [f, v] : t) {
+if (!t) {
+  fmt::print(stderr, "the fields cannot all be assigned a column\n");
+  return 1;
+}
+for (auto const& [f, v] : *t) {
   fmt::print("{}: {}\n", f, v);
 }
-auto const res2 = product_start(t, "departure");
+auto const res2 = product_start(*t, "departure");
 fmt::print("solution to part 2 is {}\n", res2);
 
 }
\ No newline at end of file
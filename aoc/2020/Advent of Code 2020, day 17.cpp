@@ -5,75 +5,28 @@
 // NB: kind-of spaghetti code, very improvable...
 
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstdint>
+#include <stdexcept>
 #include <string_view>
 #include <utility>
 #include <vector>
 #include <fmt/core.h>
 
+#include "AoC_alloc.hpp"
+#include "AoC_grid.hpp"
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_pool.hpp"
+#include "AoC_probe.hpp"
+
 auto constexpr active = '#';
 auto constexpr inactive = '.';
 
-std::string_view fetch_line(std::string_view& text) {
-  auto const pos = text.find('\n');
-  auto res = text.substr(0, pos);
-  text.remove_prefix(pos+1);
-  return res;
-}
-
-template<class T>
-class Matrix
-{
-  std::vector<T> data_;
-  std::size_t cols_;
-public:
-  Matrix(std::size_t rows, std::size_t cols, T const& value)
-  : data_(rows*cols, value)
-  , cols_{cols}
-  { }
- 
-  void add_row(T const& value) {
-    auto const idx = data_.size();
-    data_.resize(data_.size() + cols_);
-    std::fill_n(std::next(begin(data_), idx), cols_, value);
-  }
-
-  template<class It>
-  void add_row(It first, It last) {
-    assert(std::distance(first, last) == cols_);
-    auto const idx = data_.size();
-    data_.resize(data_.size() + cols_);
-    std::copy(first, last, std::next(begin(data_), idx));
-  }
-
-  std::size_t rows() const noexcept { return data_.size() / cols_; }
-  std::size_t cols() const noexcept { return cols_; }
-
-  T at(std::size_t row, std::size_t col) const noexcept {
-    return data_[row*cols_ + col];
-  }
-
-  void set(std::size_t row, std::size_t col, T value) noexcept {
-    data_[idx(row, col)] = std::move(value);
-  }
-
-  std::size_t count(T const& value) const noexcept {
-    return std::count(begin(data_), end(data_), value);
-  }
-
-private:
-  std::size_t idx(std::size_t row, std::size_t col) const noexcept {
-    return row*cols_ + col;
-  }
-  auto iterator(std::size_t row, std::size_t col) const noexcept {
-    return std::next(begin(data_), idx(row, col));
-  }
-
-};
-
-void print(Matrix<bool> const& m, std::pair<char, char> const repr = {active, inactive}, std::string_view const at_the_end = "\n") {
-  for (std::size_t i = 0; i < m.rows(); ++i) {
-    for (std::size_t j = 0; j < m.cols(); ++j) {
+void print(aoc::Grid<bool> const& m, std::pair<char, char> const repr = {active, inactive}, std::string_view const at_the_end = "\n") {
+  for (std::ptrdiff_t i = 0; i < static_cast<std::ptrdiff_t>(m.rows()); ++i) {
+    for (std::ptrdiff_t j = 0; j < static_cast<std::ptrdiff_t>(m.cols()); ++j) {
       fmt::print("{}", m.at(i, j) ? repr.first : repr.second);
     }
     fmt::print("\n");
@@ -83,12 +36,12 @@ void print(Matrix<bool> const& m, std::pair<char, char> const repr = {active, in
 
 template<class T>
 class Cube {
-  std::vector<Matrix<T>> slices_;
+  std::vector<aoc::Grid<T>> slices_;
 public:
   Cube(std::size_t r, std::size_t c, std::size_t s, T value) {
     slices_.reserve(s);
     for (std::size_t i = 0; i < s; ++i) { // s-times
-      slices_.push_back(Matrix<T>(r, c, value));
+      slices_.push_back(aoc::Grid<T>(r, c, value));
     }
   }
 
@@ -102,12 +55,12 @@ public:
     return slices_.front().cols();
   }
 
-  T at(std::size_t row, std::size_t col, std::size_t s) const noexcept {
-    return slices_[s].at(row, col);
+  T at(std::ptrdiff_t row, std::ptrdiff_t col, std::ptrdiff_t s) const noexcept {
+    return slices_[static_cast<std::size_t>(s)].at(row, col);
   }
 
-  void set(std::size_t row, std::size_t col, std::size_t s, T value) noexcept {
-    slices_[s].set(row, col, value);
+  void set(std::ptrdiff_t row, std::ptrdiff_t col, std::ptrdiff_t s, T value) noexcept {
+    slices_[static_cast<std::size_t>(s)].set(row, col, value);
   }
 
   std::size_t count(T const& value) const noexcept {
@@ -118,29 +71,30 @@ public:
     return res;
   }
 
-  void add(Matrix<T> slice) {
+  void add(aoc::Grid<T> slice) {
     slices_.push_back(std::move(slice));
   }
 
-  Matrix<T> const& slice(std::size_t i) const {
+  aoc::Grid<T> const& slice(std::size_t i) const {
     return slices_[i];
   }
 
 };
 
-Cube<bool> parse_reserve_for(std::string_view s, int const t) {
-  auto line = fetch_line(s);
-  std::vector<bool> buffer(2*t + line.size(), false);
-  Matrix<bool> slice(t, buffer.size(), false);
+Cube<bool> parse_reserve_for(std::string_view s, std::size_t const t) {
+  auto first = aoc::fetch_line(s);
+  std::vector<bool> buffer(2*t + first.size(), false);
+  aoc::Grid<bool> slice(t, buffer.size(), false);
+  slice.reserve(2*t + 1 + s.size() / (first.size() + 1) + 1);
   auto const add_line = [&](auto& m, auto const line) {
     for (std::size_t i=0; i < line.size(); ++i) { // transform
       buffer[i+t] = line[i] == active;
     }
     m.add_row(begin(buffer), end(buffer));
   };
-  add_line(slice, line);
+  add_line(slice, first);
   while(!s.empty()) {
-    add_line(slice, fetch_line(s));
+    add_line(slice, aoc::fetch_line(s));
   }
   std::fill(begin(buffer), end(buffer), false);
   for (std::size_t i=0; i < t; ++i) { // t times
@@ -151,17 +105,17 @@ Cube<bool> parse_reserve_for(std::string_view s, int const t) {
   Cube<bool> res(r, c, t, false);
   res.add(std::move(slice));
   for (std::size_t i=0; i < t; ++i) { // t times
-    res.add(Matrix<bool>(r, c, false));
+    res.add(aoc::Grid<bool>(r, c, false));
   }
   return res;
 }
 
 template<class T>
-std::size_t count_neighbor(Cube<T> const& cube, std::size_t r, std::size_t c, std::size_t s, T const& value) {
-  auto const R = cube.rows()-1;
-  auto const C = cube.cols()-1;
-  auto const S = cube.slices()-1;
-  auto res = 0;
+std::size_t count_neighbor(Cube<T> const& cube, std::ptrdiff_t r, std::ptrdiff_t c, std::ptrdiff_t s, T const& value) {
+  auto const R = static_cast<std::ptrdiff_t>(cube.rows())-1;
+  auto const C = static_cast<std::ptrdiff_t>(cube.cols())-1;
+  auto const S = static_cast<std::ptrdiff_t>(cube.slices())-1;
+  std::size_t res = 0;
   for (auto di : {-1, 0, 1}) {
     for (auto dj : {-1, 0, 1}) {
       for (auto dk : {-1, 0, 1}) {
@@ -182,11 +136,14 @@ std::size_t count_neighbor(Cube<T> const& cube, std::size_t r, std::size_t c, st
 
 std::size_t evolve(Cube<bool>& c) {
   auto constexpr Active = true;
-  auto res = 0;
+  std::size_t res = 0;
   auto update = c;
-  for (std::size_t i = 0; i < c.rows(); ++i) {
-    for (std::size_t j = 0; j < c.cols(); ++j) {
-      for (std::size_t k = 0; k < c.slices(); ++k) {
+  auto const rows = static_cast<std::ptrdiff_t>(c.rows());
+  auto const cols = static_cast<std::ptrdiff_t>(c.cols());
+  auto const slices = static_cast<std::ptrdiff_t>(c.slices());
+  for (std::ptrdiff_t i = 0; i < rows; ++i) {
+    for (std::ptrdiff_t j = 0; j < cols; ++j) {
+      for (std::ptrdiff_t k = 0; k < slices; ++k) {
         auto const neigh = count_neighbor(c, i, j, k, Active);
         if (c.at(i, j, k) == Active) {
           if (neigh < 2 || 3 < neigh) {
@@ -238,12 +195,12 @@ public:
     return cubes_.front().cols();
   }
 
-  T at(std::size_t row, std::size_t col, std::size_t s, std::size_t h) const noexcept {
-    return cubes_[h].at(row, col, s);
+  T at(std::ptrdiff_t row, std::ptrdiff_t col, std::ptrdiff_t s, std::ptrdiff_t h) const noexcept {
+    return cubes_[static_cast<std::size_t>(h)].at(row, col, s);
   }
 
-  void set(std::size_t row, std::size_t col, std::size_t s, std::size_t h, T value) noexcept {
-    cubes_[h].set(row, col, s, value);
+  void set(std::ptrdiff_t row, std::ptrdiff_t col, std::ptrdiff_t s, std::ptrdiff_t h, T value) noexcept {
+    cubes_[static_cast<std::size_t>(h)].set(row, col, s, value);
   }
 
   std::size_t count(T const& value) const noexcept {
@@ -266,12 +223,12 @@ public:
 
 template<class T>
 std::size_t count_neighbor(HyperCube<T> const& cube,
-                           std::size_t r, std::size_t c, std::size_t s, std::size_t h, T const& value) {
-  auto const R = cube.rows()-1;
-  auto const C = cube.cols()-1;
-  auto const S = cube.slices()-1;
-  auto const H = cube.high()-1;
-  auto res = 0;
+                           std::ptrdiff_t r, std::ptrdiff_t c, std::ptrdiff_t s, std::ptrdiff_t h, T const& value) {
+  auto const R = static_cast<std::ptrdiff_t>(cube.rows())-1;
+  auto const C = static_cast<std::ptrdiff_t>(cube.cols())-1;
+  auto const S = static_cast<std::ptrdiff_t>(cube.slices())-1;
+  auto const H = static_cast<std::ptrdiff_t>(cube.high())-1;
+  std::size_t res = 0;
   for (auto di : {-1, 0, 1}) {
     for (auto dj : {-1, 0, 1}) {
       for (auto dk : {-1, 0, 1}) {
@@ -295,12 +252,16 @@ std::size_t count_neighbor(HyperCube<T> const& cube,
 
 std::size_t evolve(HyperCube<bool>& c) {
   auto constexpr Active = true;
-  auto res = 0;
+  std::size_t res = 0;
   auto update = c;
-  for (std::size_t i = 0; i < c.rows(); ++i) {
-    for (std::size_t j = 0; j < c.cols(); ++j) {
-      for (std::size_t k = 0; k < c.slices(); ++k) {
-        for (std::size_t l = 0; l < c.high(); ++l) {
+  auto const rows = static_cast<std::ptrdiff_t>(c.rows());
+  auto const cols = static_cast<std::ptrdiff_t>(c.cols());
+  auto const slices = static_cast<std::ptrdiff_t>(c.slices());
+  auto const high = static_cast<std::ptrdiff_t>(c.high());
+  for (std::ptrdiff_t i = 0; i < rows; ++i) {
+    for (std::ptrdiff_t j = 0; j < cols; ++j) {
+      for (std::ptrdiff_t k = 0; k < slices; ++k) {
+        for (std::ptrdiff_t l = 0; l < high; ++l) {
           auto const neigh = count_neighbor(c, i, j, k, l, Active);
           if (c.at(i, j, k, l) == Active) {
             if (neigh < 2 || 3 < neigh) {
@@ -322,11 +283,339 @@ std::size_t evolve(HyperCube<bool>& c) {
   return res;
 }
 
+// Conway cubes in 'Dim' dimensions, keeping track of the active cells only,
+// as a sorted flat vector of packed coordinates: '64 / Dim' biased bits per
+// axis, so that moving along an axis is a single addition which preserves the
+// order. Neighbor counts are scattered from the active cells one axis at a
+// time (the 3^Dim box sum is separable), each pass being a sequential merge
+// of the three shifted copies of the previous one. Memory and time are
+// proportional to the number of active cells.
+//
+// The coordinates must stay in [-2^(bits-1), 2^(bits-1)): as they grow by at
+// most one per generation, the input can evolve for about 2^(bits-1) minus
+// its size generations, e.g. 500 of an 8x8 input in 6D but only 120 in 8D.
+// Beyond, a step would carry into the next axis, so 'evolve' throws
+// 'std::out_of_range' instead.
+//
+// As the initial state is a single slice where all coordinates but the first
+// two are 0, the evolution is symmetric under mirroring any of these axes.
+// With 'Symmetric' only the non-negative half-spaces of them are stored, and
+// cells count with a multiplicity of 2 per nonzero mirrored coordinate; this
+// cuts memory and work by about '2^(Dim - 2)'.
+template<std::size_t Dim, bool Symmetric = false>
+class Conway {
+  static_assert(2 <= Dim && Dim <= 8);
+  static auto constexpr bits = 64 / Dim;
+  static auto constexpr bias = std::int64_t{1} << (bits - 1);
+  static auto constexpr mask = (std::uint64_t{1} << bits) - 1;
+  static auto constexpr alive = std::uint32_t{1} << 31;
+
+  struct Count {
+    std::uint64_t cell;
+    std::uint32_t value;
+  };
+
+  std::vector<std::uint64_t> active_;
+  std::vector<Count> counts_;
+  std::vector<Count> scratch_;
+  std::int64_t lo_ = 0; // bounds of the coordinates of the active cells
+  std::int64_t hi_ = 0;
+
+  static std::int64_t coordinate(std::uint64_t const cell, std::size_t const axis) {
+    return static_cast<std::int64_t>((cell >> (axis * bits)) & mask) - bias;
+  }
+
+  static bool is_mirrored(std::size_t const axis) {
+    return Symmetric && axis >= 2;
+  }
+
+  // Set 'scratch_' to the sums of 'counts_' over the 3 cells centered on
+  // every cell along 'axis'. Only the cell itself keeps its 'alive' flag. On
+  // a mirrored axis, the neighbor at -1 of a cell at 0 is the one at +1.
+  void scatter(std::size_t const axis) {
+    auto const step = std::uint64_t{1} << (axis * bits);
+    auto const mirrored = is_mirrored(axis);
+    scratch_.clear();
+    auto const n = counts_.size();
+    // Three cursors over 'counts_', read as shifted by -step, 0 and +step:
+    // the last one to run out is 'plus'.
+    std::size_t minus = 0, same = 0, plus = 0;
+    auto const skip_mirror = [&] {
+      while (mirrored && minus < n && coordinate(counts_[minus].cell, axis) == 0) {
+        ++minus;
+      }
+    };
+    skip_mirror();
+    while (plus < n) {
+      auto cell = counts_[plus].cell + step;
+      if (same < n) {
+        cell = std::min(cell, counts_[same].cell);
+      }
+      if (minus < n) {
+        cell = std::min(cell, counts_[minus].cell - step);
+      }
+      std::uint32_t value = 0;
+      if (minus < n && counts_[minus].cell - step == cell) {
+        auto const v = counts_[minus++].value & ~alive;
+        value += mirrored && coordinate(cell, axis) == 0 ? 2*v : v;
+        skip_mirror();
+      }
+      if (same < n && counts_[same].cell == cell) {
+        value += counts_[same++].value;
+      }
+      if (counts_[plus].cell + step == cell) {
+        value += counts_[plus++].value & ~alive;
+      }
+      scratch_.push_back({cell, value});
+    }
+    std::swap(counts_, scratch_);
+  }
+
+public:
+  static std::uint64_t pack(std::array<std::int64_t, Dim> const& coords) {
+    std::uint64_t res = 0;
+    for (std::size_t i = 0; i < Dim; ++i) { // enumerate
+      assert( -bias <= coords[i] && coords[i] < bias );
+      res |= static_cast<std::uint64_t>(coords[i] + bias) << (i * bits);
+    }
+    return res;
+  }
+
+  // Initial state from a 2D slice where the other coordinates are 0.
+  explicit Conway(std::string_view text) {
+    std::int64_t r = 0;
+    for (auto const line : aoc::Lines{text}) {
+      for (std::size_t c = 0; c < line.size(); ++c) { // enumerate
+        if (line[c] == active) {
+          std::array<std::int64_t, Dim> coords{};
+          coords[0] = r;
+          coords[1] = static_cast<std::int64_t>(c);
+          hi_ = std::max({hi_, coords[0], coords[1]});
+          if (hi_ >= bias) {
+            throw std::out_of_range{"Conway: the input does not fit the packed coordinates"};
+          }
+          active_.push_back(pack(coords));
+        }
+      }
+      ++r;
+    }
+    std::sort(begin(active_), end(active_));
+  }
+
+  std::size_t count() const noexcept {
+    if constexpr (!Symmetric) {
+      return active_.size();
+    }
+    std::size_t res = 0;
+    for (auto const cell : active_) { // accumulate
+      std::size_t multiplicity = 1;
+      for (std::size_t axis = 2; axis < Dim; ++axis) {
+        if (coordinate(cell, axis) != 0) {
+          multiplicity *= 2;
+        }
+      }
+      res += multiplicity;
+    }
+    return res;
+  }
+
+  void evolve() {
+    if (lo_ - 1 < -bias || hi_ + 1 >= bias) {
+      throw std::out_of_range{"Conway: too many generations for the packed coordinates"};
+    }
+    --lo_;
+    ++hi_;
+    counts_.clear();
+    for (auto const cell : active_) {
+      counts_.push_back({cell, alive | 1});
+    }
+    for (std::size_t axis = 0; axis < Dim; ++axis) {
+      scatter(axis);
+    }
+    active_.clear();
+    for (auto const [cell, v] : counts_) {
+      auto const box = v & ~alive; // neighbors and the cell itself
+      if (box == 3 || (box == 4 && (v & alive))) {
+        active_.push_back(cell);
+      }
+    }
+  }
+};
+
+template<std::size_t Dim, bool Symmetric>
+void evolve(Conway<Dim, Symmetric>& obj, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) { // n times
+    obj.evolve();
+  }
+}
+
+// Dense Conway cubes in 'Dim' dimensions, sized for a given number of
+// generations, with every row stored as 64-bit words, one bit per cell. The
+// 3^Dim box sums are computed separably (along the row, then across rows,
+// then across planes...) with bit-sliced adders, that is 64 cells at a time.
+// Only the active bounding box, grown by one each generation, is visited.
+template<std::size_t Dim>
+class BitCube {
+  static_assert(2 <= Dim && Dim <= 5);
+  // Bit planes needed to hold the box sum, up to 3^Dim.
+  static auto constexpr planes = std::size_t{Dim == 2 ? 4 : Dim == 3 ? 5 : Dim == 4 ? 7 : 8};
+  using Number = std::array<std::uint64_t, planes>;
+
+  std::array<std::size_t, Dim> extents_; // axis 0 in words
+  std::array<std::size_t, Dim> strides_; // in words
+  std::array<std::size_t, Dim> lo_;      // active box, axis 0 in bits
+  std::array<std::size_t, Dim> hi_;
+  std::vector<std::uint64_t> cells_;
+  std::vector<Number> sums_;
+  std::vector<Number> scratch_;
+
+  static Number add(Number const& a, Number const& b) {
+    Number res;
+    std::uint64_t carry = 0;
+    for (std::size_t p = 0; p < planes; ++p) {
+      res[p] = a[p] ^ b[p] ^ carry;
+      carry = (a[p] & b[p]) | (carry & (a[p] ^ b[p]));
+    }
+    return res;
+  }
+
+  // Call 'f(first, last)' with the word indexes of every row of the active
+  // box grown by one.
+  template<class F>
+  void for_each_row(F f) const {
+    std::array<std::size_t, Dim> lo, hi;
+    lo[0] = (lo_[0] - 1) / 64;
+    hi[0] = hi_[0] / 64 + 1;
+    for (std::size_t a = 1; a < Dim; ++a) {
+      lo[a] = lo_[a] - 1;
+      hi[a] = hi_[a] + 1;
+    }
+    auto i = lo;
+    for (;;) {
+      std::size_t first = 0;
+      for (std::size_t a = 0; a < Dim; ++a) { // inner product
+        first += i[a] * strides_[a];
+      }
+      f(first, first + hi[0] - lo[0]);
+      std::size_t a = 1;
+      while (a < Dim && ++i[a] == hi[a]) {
+        i[a] = lo[a];
+        ++a;
+      }
+      if (a == Dim) {
+        break;                                                       // BREAK
+      }
+    }
+  }
+
+public:
+  // Initial state from a 2D slice, ready for 'generations' evolutions.
+  BitCube(std::string_view text, std::size_t const generations) {
+    auto const margin = generations + 1;
+    std::vector<std::string_view> lines;
+    for (auto const line : aoc::Lines{text}) {
+      lines.push_back(line);
+    }
+    auto const width = lines.empty() ? std::size_t{0} : lines.front().size();
+    extents_[0] = (margin + width + margin + 63) / 64 + 2;
+    extents_[1] = margin + lines.size() + margin;
+    for (std::size_t a = 2; a < Dim; ++a) {
+      extents_[a] = 2*margin + 1;
+    }
+    strides_[0] = 1;
+    for (std::size_t a = 1; a < Dim; ++a) {
+      strides_[a] = strides_[a - 1] * extents_[a - 1];
+    }
+    auto const size = strides_[Dim - 1] * extents_[Dim - 1];
+    cells_.resize(size);
+    sums_.resize(size);
+    scratch_.resize(size);
+    lo_[0] = 64 + margin;
+    hi_[0] = lo_[0] + width;
+    lo_[1] = margin;
+    hi_[1] = lo_[1] + lines.size();
+    for (std::size_t a = 2; a < Dim; ++a) {
+      lo_[a] = margin;
+      hi_[a] = margin + 1;
+    }
+    std::size_t base = 0;
+    for (std::size_t a = 2; a < Dim; ++a) { // inner product
+      base += margin * strides_[a];
+    }
+    for (std::size_t r = 0; r < lines.size(); ++r) { // enumerate
+      for (std::size_t c = 0; c < width; ++c) { // enumerate
+        if (lines[r][c] == active) {
+          auto const x = lo_[0] + c;
+          cells_[base + (lo_[1] + r) * strides_[1] + x / 64] |= std::uint64_t{1} << (x % 64);
+        }
+      }
+    }
+  }
+
+  std::size_t count() const noexcept {
+    return aoc::popcount(cells_);
+  }
+
+  void evolve() {
+    auto const no_alloc = aoc::NoAllocation{"BitCube::evolve"};
+    for (std::size_t a = 0; a < Dim; ++a) {
+      assert( 1 < lo_[a] && hi_[a] + 1 < (a == 0 ? 64 * extents_[0] - 64 : extents_[a]) );
+    }
+    // Along the row: 3 neighbors of one bit each, shifted across words.
+    for_each_row([&](std::size_t const first, std::size_t const last) {
+      for (auto i = first; i < last; ++i) {
+        auto const c = cells_[i];
+        auto const l = (c << 1) | (cells_[i - 1] >> 63);
+        auto const r = (c >> 1) | (cells_[i + 1] << 63);
+        Number n{};
+        n[0] = l ^ c ^ r;
+        n[1] = (l & c) | (r & (l ^ c));
+        sums_[i] = n;
+      }
+    });
+    // Across rows, planes...
+    for (std::size_t a = 1; a < Dim; ++a) {
+      auto const stride = strides_[a];
+      for_each_row([&](std::size_t const first, std::size_t const last) {
+        for (auto i = first; i < last; ++i) {
+          scratch_[i] = add(add(sums_[i - stride], sums_[i]), sums_[i + stride]);
+        }
+      });
+      std::swap(sums_, scratch_);
+    }
+    // A cell with a box sum of 3 is active next, and so is an active cell
+    // with a box sum of 4.
+    for_each_row([&](std::size_t const first, std::size_t const last) {
+      for (auto i = first; i < last; ++i) {
+        auto const& n = sums_[i];
+        std::uint64_t high = 0;
+        for (std::size_t p = 3; p < planes; ++p) {
+          high |= n[p];
+        }
+        auto const three = n[0] & n[1] & ~n[2];
+        auto const four = ~n[0] & ~n[1] & n[2];
+        cells_[i] = ~high & (three | (four & cells_[i]));
+      }
+    });
+    for (std::size_t a = 0; a < Dim; ++a) {
+      --lo_[a];
+      ++hi_[a];
+    }
+  }
+};
+
+template<std::size_t Dim>
+void evolve(BitCube<Dim>& obj, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) { // n times
+    obj.evolve();
+  }
+}
+
 //////////////////////////////////////////////////////////////////////
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(.#.
+[[maybe_unused]] auto const test = R"(.#.
 ..#
 ###
 )";
@@ -341,33 +630,75 @@ auto const input = R"(##.#####
 .#.#.#..
 )";
 
-auto const t = 6;
-
-auto const source = parse_reserve_for(input, t);
-/*
-for (std::size_t i=0; i < source.slices(); ++i) {
-  fmt::print("{}. ---------------------------------------\n", i);
-  print(source.slice(i));
-}
-*/
-auto cube = source;
-evolve(cube, t);
-/*
-for (std::size_t i=0; i < cube.slices(); ++i) {
-  fmt::print("{}. ---------------------------------------\n", i);
-  print(cube.slice(i));
+auto const text = aoc::input(argc, argv, input);
+auto const t = std::size_t{6};
+
+std::size_t res1 = 0, res2 = 0, res5 = 0, res6 = 0;
+aoc::parallel_invoke(
+  [&] {
+    auto const part = aoc::Probe{"part 1"};
+    auto bitcube3 = BitCube<3>{text, t};
+    evolve(bitcube3, t);
+    res1 = bitcube3.count();
+  },
+  [&] {
+    auto const part = aoc::Probe{"part 2"};
+    auto bitcube4 = BitCube<4>{text, t};
+    evolve(bitcube4, t);
+    res2 = bitcube4.count();
+  },
+  [&] {
+    auto const part = aoc::Probe{"5D"};
+    auto conway5 = Conway<5, true>{text};
+    evolve(conway5, t);
+    res5 = conway5.count();
+  },
+  [&] {
+    auto const part = aoc::Probe{"6D"};
+    auto conway6 = Conway<6, true>{text};
+    evolve(conway6, t);
+    res6 = conway6.count();
+  });
+#ifndef NDEBUG // cross-check of the bit-parallel kernel, out of the timed parts
+{
+  auto const source = parse_reserve_for(text, t);
+  /*
+  for (std::size_t i=0; i < source.slices(); ++i) {
+    fmt::print("{}. ---------------------------------------\n", i);
+    print(source.slice(i));
+  }
+  */
+  auto cube = source;
+  evolve(cube, t);
+  /*
+  for (std::size_t i=0; i < cube.slices(); ++i) {
+    fmt::print("{}. ---------------------------------------\n", i);
+    print(cube.slice(i));
+  }
+  */
+  assert( res1 == cube.count(true) );
+  auto conway3 = Conway<3>{text};
+  evolve(conway3, t);
+  assert( res1 == conway3.count() );
+
+  auto hypercube = HyperCube{source.rows(), source.cols(), source.slices(), t, false};
+  hypercube.add(source);
+  for (std::size_t i=0; i<t; ++i) { // t times
+    hypercube.add(Cube<bool>(source.rows(), source.cols(), source.slices(), false));
+  }
+  evolve(hypercube, t);
+  assert( res2 == hypercube.count(true) );
+  auto conway4 = Conway<4>{text};
+  evolve(conway4, t);
+  assert( res2 == conway4.count() );
+  auto folded4 = Conway<4, true>{text};
+  evolve(folded4, t);
+  assert( res2 == folded4.count() );
 }
-*/
-auto const res1 = cube.count(true);
+#endif
 fmt::print("After {} evolutions {} are active\n", t, res1);
-
-auto hypercube = HyperCube{source.rows(), source.cols(), source.slices(), t, false};
-hypercube.add(source);
-for (std::size_t i=0; i<t; ++i) { // t times
-  hypercube.add(Cube<bool>(source.rows(), source.cols(), source.slices(), false));  
-}
-evolve(hypercube, t);
-auto const res2 = hypercube.count(true);
 fmt::print("After {} evolutions {} are active\n", t, res2);
+fmt::print("In 5D, after {} evolutions {} are active\n", t, res5);
+fmt::print("In 6D, after {} evolutions {} are active\n", t, res6);
 
 }
\ No newline at end of file
@@ -3,153 +3,287 @@
 // Godbolt link: https://godbolt.org/z/jjes3f
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstdint>
-#include <stack>
+#include <stdexcept>
 #include <string_view>
 #include <utility>
 #include <vector>
 #include <fmt/core.h>
 
+#include "AoC_alloc.hpp"
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_pool.hpp"
+#include "AoC_probe.hpp"
+
 using Int = std::int64_t;
 
-bool is_digit(char const c) {
-  return '0' <= c && c <= '9';
-}
+enum OP : char { Plus, Prod };
 
-template<class It>
-auto to_int(It& first, It const last, char const init) {
-  Int res = init - '0';
-  while (first != last) {
-    res = res*10 + (*first++ - '0');
-  }
-  return res;
-}
+// Binding power of every operator, indexed by 'OP': the higher the tighter.
+// Operators of the same power associate to the left.
+using Precedence = std::array<int, 2>;
 
-std::string_view fetch_line(std::string_view& text) {
-  auto const pos = text.find('\n');
-  auto res = text.substr(0, pos);
-  text.remove_prefix(pos == std::string_view::npos ? text.size() : pos+1);
-  return res;
-}
+auto constexpr no_precedence = Precedence{1, 1};
+auto constexpr add_first = Precedence{2, 1};
+
+struct Token {
+  enum Kind : char { Number, Operator, Open, Close, EndOfLine };
+  Kind kind;
+  OP op;
+  Int value;
+};
 
-void skip_to_digit(std::string_view& text) {
-  auto const it = std::find_if(begin(text), end(text), is_digit);
-  auto const pos = std::distance(begin(text), it);
-  text.remove_prefix(pos);
+// Replace 'tokens' by the tokens of all the lines in 'text', each line being
+// terminated by 'EndOfLine', so that the text is scanned once whatever the
+// precedences. The capacity of 'tokens' is reused. Blank lines are skipped,
+// and any character but digits, operators, parentheses and spaces throws
+// 'std::invalid_argument'.
+void tokenize(std::string_view text, std::vector<Token>& tokens) {
+  tokens.clear();
+  for (auto line : aoc::Lines{text}) {
+    auto const size = tokens.size();
+    while (!line.empty()) {
+      switch (line.front()) {
+        case ' ': break;
+        case '+': { tokens.push_back({Token::Operator, Plus, 0}); break; }
+        case '*': { tokens.push_back({Token::Operator, Prod, 0}); break; }
+        case '(': { tokens.push_back({Token::Open, Plus, 0}); break; }
+        case ')': { tokens.push_back({Token::Close, Plus, 0}); break; }
+        default: {
+          if (line.front() < '0' || line.front() > '9') {
+            throw std::invalid_argument{fmt::format("unexpected character {:#04x} in expression",
+                                                    static_cast<unsigned char>(line.front()))};
+          }
+          tokens.push_back({Token::Number, Plus, aoc::fetch_int<Int>(line)});
+          continue;                                                  // CONTINUE
+        }
+      }
+      line.remove_prefix(1);
+    }
+    if (tokens.size() != size) {
+      tokens.push_back({Token::EndOfLine, Plus, 0});
+    }
+  }
 }
 
-//////////////////////////////////////////////////////////////////////////
+struct Instruction {
+  enum Code : char { Push, Add, Mul, End };
+  Code code;
+  Int value;
+};
 
-enum OP : char { Plus, Prod };
+// Precedence-climbing compiler from tokens to a flat RPN program, where
+// 'End' closes every line. A malformed line throws 'std::invalid_argument';
+// as every line ends with 'EndOfLine', which is never consumed but by
+// 'compile', the tokens are never read past the end.
+class Compiler {
+  std::vector<Token> const& tokens_;
+  Precedence const& precedence_;
+  std::vector<Instruction>& program_;
+  std::size_t pos_ = 0;
 
-void apply(Int& res, OP op, Int i) {
-  switch(op) {
-    case Plus: /*fmt::print("{} + {} = {}\n", res, i, res+i);*/ res += i; break;
-    case Prod: /*fmt::print("{} * {} = {}\n", res, i, res*i);*/ res *= i; break;
+  void expect(Token::Kind const kind) const {
+    if (tokens_[pos_].kind != kind) {
+      throw std::invalid_argument{"malformed expression"};
+    }
   }
-}
 
-Int solve_no_precedence(std::string_view::iterator& first, std::string_view::iterator const last) {
-  Int res = 0;
-  OP op = Plus;
-  while (first != last) {
-    auto const c = *first++;
-    switch (c) {
-      case ' ': break;
-      case '+': { op = Plus; break; }
-      case '*': { op = Prod; break; }
-      case '(': { apply(res, op, solve_no_precedence(first, last)); break; }
-      case ')': return res;
-      default: { // digit
-        auto const l = std::find_if_not(first, last, is_digit);
-        apply(res, op, to_int(first, l, c));
-      }
+  void primary() {
+    if (tokens_[pos_].kind == Token::Open) {
+      ++pos_;
+      expression(0);
+      expect(Token::Close);
+      ++pos_;
+    }
+    else {
+      expect(Token::Number);
+      program_.push_back({Instruction::Push, tokens_[pos_++].value});
     }
   }
-  return res;
-}
 
-void apply(std::stack<Int>& s, OP op, Int const v) {
-  assert( !s.empty() );
-  if (op == Prod) {
-    s.push(v);
+  void expression(int const min) {
+    primary();
+    while (tokens_[pos_].kind == Token::Operator && precedence_[tokens_[pos_].op] >= min) {
+      auto const op = tokens_[pos_++].op;
+      expression(precedence_[op] + 1);
+      program_.push_back({op == Plus ? Instruction::Add : Instruction::Mul, 0});
+    }
   }
-  else { // Plus
-    auto const sum = s.top() + v;
-    s.pop();
-    s.push(sum);
+
+public:
+  Compiler(std::vector<Token> const& tokens, Precedence const& precedence,
+           std::vector<Instruction>& program)
+    : tokens_{tokens}, precedence_{precedence}, program_{program} {}
+
+  void compile() {
+    while (pos_ < tokens_.size()) {
+      expression(0);
+      expect(Token::EndOfLine);
+      ++pos_;
+      program_.push_back({Instruction::End, 0});
+    }
   }
+};
+
+// Replace 'program' by the compilation of 'tokens' under 'precedence'; the
+// capacity of 'program' is reused.
+void compile(std::vector<Token> const& tokens, Precedence const& precedence,
+             std::vector<Instruction>& program) {
+  program.clear();
+  Compiler{tokens, precedence, program}.compile();
 }
 
-Int unwind(std::stack<Int>& s) {
-  assert( !s.empty() );
-  Int res = 1;
-  while (!s.empty()) {
-    res *= s.top();
-    s.pop();
+__extension__ using Wide = __int128;
+
+// Sum of the values of several lines, where the lines whose value overflowed
+// 'T' (or would have made the sum overflow) are counted and left out. Sums
+// of several lines that cannot be added up are left out as well, which is
+// flagged by 'merge_overflow' since the number of lines they span is unknown.
+template<class T>
+struct Total {
+  T value = 0;
+  std::size_t overflows = 0;
+  bool merge_overflow = false;
+
+  void add(T const v) {
+    T sum;
+    if (__builtin_add_overflow(value, v, &sum)) {
+      ++overflows;
+    }
+    else {
+      value = sum;
+    }
   }
-  return res;
-}
 
-Int solve_add_first(std::string_view::iterator& first, std::string_view::iterator const last) {
-  OP op = Plus;
-  std::stack<Int> s;
-  s.push(0);
-  while (first != last) {
-    auto const c = *first++;
-    switch (c) {
-      case ' ': break;
-      case '+': { op = Plus; break; }
-      case '*': { op = Prod; break; }
-      case '(': { apply(s, op, solve_add_first(first, last)); break; }
-      case ')': return unwind(s);
-      default: { // digit
-        auto const v = to_int(first, std::find_if_not(first, last, is_digit), c);
-        apply(s, op, v);
+  void add(Total const& other) {
+    T sum;
+    if (__builtin_add_overflow(value, other.value, &sum)) {
+      merge_overflow = true;
+    }
+    else {
+      value = sum;
+    }
+    overflows += other.overflows;
+    merge_overflow |= other.merge_overflow;
+  }
+};
+
+// Return the sum of the values of all the lines of 'program', computed in 'T'
+// and using 'stack' as scratch memory.
+template<class T>
+Total<T> evaluate(std::vector<Instruction> const& program, std::vector<T>& stack) {
+  Total<T> res;
+  bool overflow = false;
+  stack.clear();
+  for (auto const& [code, value] : program) {
+    switch (code) {
+      case Instruction::Push: { stack.push_back(value); break; }
+      case Instruction::Add: {
+        auto const rhs = stack.back();
+        stack.pop_back();
+        overflow |= __builtin_add_overflow(stack.back(), rhs, &stack.back());
+        break;
+      }
+      case Instruction::Mul: {
+        auto const rhs = stack.back();
+        stack.pop_back();
+        overflow |= __builtin_mul_overflow(stack.back(), rhs, &stack.back());
+        break;
+      }
+      case Instruction::End: {
+        assert( stack.size() == 1 );
+        if (overflow) {
+          ++res.overflows;
+        }
+        else {
+          res.add(stack.back());
+        }
+        overflow = false;
+        stack.pop_back();
+        break;
       }
     }
   }
-  return unwind(s);
+  return res;
 }
 
+auto parse_solve(std::string_view text, Precedence const& precedence)
+{
+  std::vector<Token> tokens;
+  std::vector<Instruction> program;
+  std::vector<Int> stack;
+  tokenize(text, tokens);
+  compile(tokens, precedence, program);
+  auto const res = evaluate(program, stack);
+  assert( res.overflows == 0 );
+  return res.value;
+}
 
-template<class S>
-auto parse_solve(std::string_view text, S&& solver)
+// Return the sum of the values of all the lines of 'text', evaluated under
+// 'precedence' in 128 bits. 'text' is split at newline boundaries into
+// 'shards' shards solved in parallel on the thread pool, and every shard is
+// gone through by blocks of about 'block' bytes with its own scratch buffers.
+Total<Wide> parallel_solve(std::string_view const text, Precedence const& precedence,
+                           std::size_t const shards = aoc::thread_count(),
+                           std::size_t const block = 1 << 16)
 {
-  Int res = 0;
-  while (!text.empty()) {
-    auto const line = fetch_line(text);
-    auto first = begin(line);
-    auto const r = solver(first, end(line));
-    res += r;
-    //fmt::print("{}\n", r);
-  }
-  return res;
+  auto const split = [&](std::size_t pos) { // first line starting at 'pos' or later
+    if (pos == 0 || pos >= text.size()) {
+      return std::min(pos, text.size());                             // RETURN
+    }
+    auto const nl = text.find('\n', pos - 1);
+    return nl == std::string_view::npos ? text.size() : nl + 1;
+  };
+  auto const solve_shard = [&](std::size_t const i) {
+    auto const first = split(text.size() * i / shards);
+    auto shard = text.substr(first, split(text.size() * (i + 1) / shards) - first);
+    std::vector<Token> tokens;
+    std::vector<Instruction> program;
+    std::vector<Wide> stack;
+    Total<Wide> res;
+    while (!shard.empty()) {
+      auto const nl = shard.size() <= block ? std::string_view::npos : shard.find('\n', block);
+      auto const size = nl == std::string_view::npos ? shard.size() : nl + 1;
+      tokenize(shard.substr(0, size), tokens);
+      compile(tokens, precedence, program);
+      stack.reserve(program.size()); // bound to the depth of any line
+      {
+        auto const no_alloc = aoc::NoAllocation{"evaluate"};
+        res.add(evaluate(program, stack));
+      }
+      shard.remove_prefix(size);
+    }
+    return res;
+  };
+  return aoc::parallel_reduce(std::size_t{0}, shards, Total<Wide>{}, solve_shard,
+                              [](Total<Wide> lhs, Total<Wide> const& rhs) { lhs.add(rhs); return lhs; });
 }
 
 //////////////////////////////////////////////////////////////////////
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test1 = R"( 1 + 2 * 3 + 4 * 5 + 6 )";
-assert(( parse_solve(test1, solve_no_precedence) == 71 ));
-assert(( parse_solve(test1, solve_add_first) == 231 ));
-auto const test2 = R"( 1 + (2 * 3) + (4 * (5 + 6)) )";
-assert(( parse_solve(test2, solve_no_precedence) == 51 ));
-assert(( parse_solve(test2, solve_add_first) == 51 ));
-auto const test3 = R"( 2 * 3 + (4 * 5) )";
-assert(( parse_solve(test3, solve_no_precedence) == 26 ));
-assert(( parse_solve(test3, solve_add_first) == 46 ));
-auto const test4 = R"( 5 + (8 * 3 + 9 + 3 * 4 * 3) )";
-assert(( parse_solve(test4, solve_no_precedence) == 437 ));
-assert(( parse_solve(test4, solve_add_first) == 1445 ));
-auto const test5 = R"( 5 * 9 * (7 * 3 * 3 + 9 * 3 + (8 + 6 * 4)) )";
-assert(( parse_solve(test5, solve_no_precedence) == 12240 ));
-assert(( parse_solve(test5, solve_add_first) == 669060 ));
-auto const test6 = R"( ((2 + 4 * 9) * (6 + 9 * 8 + 6) + 6) + 2 + 4 * 2 )";
-assert(( parse_solve(test6, solve_no_precedence) == 13632 ));
-assert(( parse_solve(test6, solve_add_first) == 23340 ));
+[[maybe_unused]] auto const test1 = R"( 1 + 2 * 3 + 4 * 5 + 6 )";
+assert(( parse_solve(test1, no_precedence) == 71 ));
+assert(( parse_solve(test1, add_first) == 231 ));
+[[maybe_unused]] auto const test2 = R"( 1 + (2 * 3) + (4 * (5 + 6)) )";
+assert(( parse_solve(test2, no_precedence) == 51 ));
+assert(( parse_solve(test2, add_first) == 51 ));
+[[maybe_unused]] auto const test3 = R"( 2 * 3 + (4 * 5) )";
+assert(( parse_solve(test3, no_precedence) == 26 ));
+assert(( parse_solve(test3, add_first) == 46 ));
+[[maybe_unused]] auto const test4 = R"( 5 + (8 * 3 + 9 + 3 * 4 * 3) )";
+assert(( parse_solve(test4, no_precedence) == 437 ));
+assert(( parse_solve(test4, add_first) == 1445 ));
+[[maybe_unused]] auto const test5 = R"( 5 * 9 * (7 * 3 * 3 + 9 * 3 + (8 + 6 * 4)) )";
+assert(( parse_solve(test5, no_precedence) == 12240 ));
+assert(( parse_solve(test5, add_first) == 669060 ));
+[[maybe_unused]] auto const test6 = R"( ((2 + 4 * 9) * (6 + 9 * 8 + 6) + 6) + 2 + 4 * 2 )";
+assert(( parse_solve(test6, no_precedence) == 13632 ));
+assert(( parse_solve(test6, add_first) == 23340 ));
 
 auto const input = R"(9 + 3 * (9 * (9 + 3 + 5 * 3) * 5 * 3 * 5)
 5 + 9 * 7 + 5 + 7 + (6 * (4 * 9 + 5 * 7 + 7 + 7) * (7 * 7 + 9 * 5) * 6 + 4 * 9)
@@ -529,10 +663,31 @@ auto const input = R"(9 + 3 * (9 * (9 + 3 + 5 * 3) * 5 * 3 * 5)
 2 + (4 * 8 * 7 + (8 * 8 * 4) * 2 * (2 + 6 + 7 * 9 * 4 + 2))
 )";
 
-auto const res1 = parse_solve(input, solve_no_precedence);
-fmt::print("res to part 1 is {}\n", res1);
-
-auto const res2 = parse_solve(input, solve_add_first);
-fmt::print("res to part 2 is {}\n", res2);
+auto const text = aoc::input(argc, argv, input);
+Total<Wide> res1, res2;
+try {
+  aoc::parallel_invoke(
+    [&] {
+      auto const part = aoc::Probe{"part 1"};
+      res1 = parallel_solve(text, no_precedence);
+    },
+    [&] {
+      auto const part = aoc::Probe{"part 2"};
+      res2 = parallel_solve(text, add_first);
+    });
+}
+catch (std::invalid_argument const& e) {
+  fmt::print(stderr, "{}\n", e.what());
+  return 1;
+}
+for (auto const& [part, res] : {std::pair{1, res1}, std::pair{2, res2}}) {
+  fmt::print("res to part {} is {}\n", part, res.value);
+  if (res.overflows != 0) {
+    fmt::print("  leaving out {} lines overflowing 128 bits\n", res.overflows);
+  }
+  if (res.merge_overflow) {
+    fmt::print("  leaving out the sums of blocks of lines overflowing 128 bits\n");
+  }
+}
 
 }
\ No newline at end of file
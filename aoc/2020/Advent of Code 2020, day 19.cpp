@@ -3,42 +3,35 @@
 // Godbolt link: https://godbolt.org/z/3oWd34
 
 #include <algorithm>
+#include <array>
+#include <bitset>
 #include <cassert>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory_resource>
+#include <optional>
+#include <span>
 #include <string_view>
 #include <unordered_map>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 #include <fmt/core.h>
 
-bool is_digit(char const c) {
-  return '0' <= c && c <= '9';
-}
+#include "AoC_arena.hpp"
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_pool.hpp"
+#include "AoC_probe.hpp"
 
-auto fetch_int(std::string_view& s) {
-  int res = 0;
-  std::size_t pos = std::find_if(begin(s), end(s), is_digit) - begin(s);
-  while (pos != s.size() && is_digit(s[pos])) {
-    res = res*10 + (s[pos++] - '0');
-  }
-  s.remove_prefix(pos);
-  return res;
-}
+template <class T> using iMap = std::pmr::unordered_map<int, T>;
 
-std::string_view fetch_line(std::string_view& text) {
-  auto const pos = text.find('\n');
-  auto res = text.substr(0, pos);
-  text.remove_prefix(pos == std::string_view::npos ? text.size() : pos+1);
-  return res;
-}
-
-//////////////////////////////////////////////////////////////////////////
-
-template <class T> using iMap = std::unordered_map<int, T>;
-
-auto parse_rules(std::string_view& s) {
-  iMap<std::string_view> res;
-  for (auto line = fetch_line(s); !line.empty(); line = fetch_line(s)) {
-    auto const i = fetch_int(line);
+auto parse_rules(std::string_view& s, std::pmr::memory_resource* const resource) {
+  auto const no_alloc = aoc::NoAllocation{"parse_rules"};
+  iMap<std::string_view> res{resource};
+  for (auto line = aoc::fetch_line(s); !line.empty(); line = aoc::fetch_line(s)) {
+    auto const i = aoc::fetch_int(line);
     line.remove_prefix(2); // colon and space
     res.emplace(i, line);
   }
@@ -47,12 +40,13 @@ auto parse_rules(std::string_view& s) {
 
 class Rule {
   static auto constexpr missing = '#';
-  std::vector<int> v_;
-  std::vector<int> alt_;
+  std::pmr::vector<int> v_;
+  std::pmr::vector<int> alt_;
   char c_;
   int i_;
 public:
-  explicit Rule(int i, char const c = missing) : i_{i}, c_{c} {}
+  Rule(int i, std::pmr::memory_resource* const resource, char const c = missing)
+    : v_{resource}, alt_{resource}, c_{c}, i_{i} {}
   
   void add_main(int const i) {
     v_.push_back(i);
@@ -61,108 +55,633 @@ public:
     alt_.push_back(i);
   }
 
-  bool matches_exactly(std::string_view s, iMap<Rule> const& rules) const {
-    return matches(s, rules) && s.empty();
+  bool is_terminal() const {
+    return c_ != missing;
   }
-
-  int matches_n(std::string_view& s, iMap<Rule> const& rules) const {
-    int times = 0;
-    for (;;) {
-      auto cpy = s;
-      auto const m = matches(cpy, rules);
-      if (!m) break;
-      s = cpy;
-      ++times;
-    }
-//fmt::print("{} matched {} times\n", i_, times);
-    return times;
+  char terminal() const {
+    return c_;
   }
-
-  bool matches(std::string_view& s, iMap<Rule> const& rules) const {
-    if (c_ != missing) {
-      if (s.empty()) return false;
-      auto const f = s.front();
-      s.remove_prefix(1);
-      return c_ == f;
+  // Return the sequences of sub-rules this rule matches, one per alternative
+  // (none for a rule missing from the input).
+  std::vector<std::span<int const>> alternatives() const {
+    std::vector<std::span<int const>> res;
+    if (!v_.empty()) {
+      res.push_back(v_);
     }
-    auto const matcher = [&](auto const& v, auto& str) {
-      return std::all_of(begin(v), end(v), [&](int const i) {
-        auto const& rule = rules.at(i);
-        return rule.matches(str, rules);
-      });
-    };
     if (!alt_.empty()) {
-      auto cpy = s;
-      auto const matches_alt = matcher(alt_, cpy);
-      if (matches_alt) {
-        s = cpy;
-        return true;
-      }
+      res.push_back(alt_);
     }
-    return matcher(v_, s);
+    return res;
   }
-
 };
 
-auto solve_rules(std::unordered_map<int, std::string_view> const& rules) {
-  iMap<Rule> res;
-  for (auto const [i, s] : rules) {
+// Rules indexed by their id.
+using Rules = std::pmr::vector<Rule>;
+
+// Return the rules, from 0 up to the largest id defined or referenced, so that
+// any id met in them is a valid index: the missing ones match nothing.
+auto solve_rules(iMap<std::string_view> const& rules, std::pmr::memory_resource* const resource) {
+  auto const no_alloc = aoc::NoAllocation{"solve_rules"};
+  auto n = 1; // rule 0, the root
+  for (auto const& [i, s] : rules) {
+    n = std::max(n, i + 1);
+  }
+  Rules res{resource};
+  res.reserve(static_cast<std::size_t>(n));
+  for (int i = 0; i < n; ++i) {
+    res.emplace_back(i, resource);
+  }
+  auto const reference = [&](int const i) {
+    while (res.size() <= static_cast<std::size_t>(i)) {
+      res.emplace_back(static_cast<int>(res.size()), resource);
+    }
+    return i;
+  };
+  for (auto const& [i, s] : rules) {
     if (s.front() == '"') {
-      res.emplace(i, Rule(i, s[1]));  
+      res[static_cast<std::size_t>(i)] = Rule(i, resource, s[1]);
     }
     else {
       auto const pipe = s.find('|');
       auto f = s.substr(0, pipe-1); // ignore space
-      Rule rule(i);
+      Rule rule(i, resource);
       while (!f.empty()) {
-        rule.add_main(fetch_int(f));
+        rule.add_main(reference(aoc::fetch_int(f)));
       }
       auto const has_pipe = pipe != std::string_view::npos;
       if (has_pipe) {
         auto alt = s.substr(pipe);
         while (!alt.empty()) {
-          rule.add_alt(fetch_int(alt));
+          rule.add_alt(reference(aoc::fetch_int(alt)));
         }
       }
-      res.emplace(i, std::move(rule));
+      res[static_cast<std::size_t>(i)] = std::move(rule);
     }
   }
   return res;
 }
 
-auto parse_solve(std::string_view text)
+// Matcher computing the set of all the positions where a rule can end when
+// starting at a given position of a message shorter than 'max_size', memoized
+// by (rule, start) within the message, so that the work is bounded by
+// O(rules * size^2). Left-recursive rules are not supported: a rule would
+// reenter itself at the same start and see its own memo half built, so they
+// must be told apart with 'is_left_recursive' beforehand.
+class PositionMatcher {
+public:
+  static auto constexpr max_size = std::size_t{128};
+  using Positions = std::bitset<max_size>;
+
+private:
+  // Return whether a rule reachable from 'i' through the first sub-rules of
+  // the alternatives, none being empty, reaches itself.
+  static bool is_left_recursive(Rules const& rules, int const i, std::vector<int>& color) {
+    auto const u = static_cast<std::size_t>(i);
+    if (color[u] != 0) {
+      return color[u] == 1;                                          // RETURN
+    }
+    color[u] = 1; // in progress
+    for (auto const& sequence : rules[u].alternatives()) {
+      if (is_left_recursive(rules, sequence.front(), color)) {
+        return true;                                                 // RETURN
+      }
+    }
+    color[u] = 2;
+    return false;
+  }
+
+  Rules const& rules_;
+  std::string_view s_;
+  std::vector<Positions> memo_;     // by (rule, start)
+  std::vector<std::uint64_t> seen_; // message during which it was computed
+  std::uint64_t epoch_ = 0;
+
+  Positions const& ends(int const rule, std::size_t const start) {
+    auto const key = static_cast<std::size_t>(rule) * max_size + start;
+    auto& res = memo_[key];
+    if (seen_[key] == epoch_) {
+      return res;                                                    // RETURN
+    }
+    seen_[key] = epoch_;
+    res.reset();
+    auto const& r = rules_[static_cast<std::size_t>(rule)];
+    if (r.is_terminal()) {
+      if (start < s_.size() && s_[start] == r.terminal()) {
+        res.set(start + 1);
+      }
+      return res;                                                    // RETURN
+    }
+    Positions alternatives;
+    for (auto const& sequence : r.alternatives()) {
+      Positions positions;
+      positions.set(start);
+      for (auto const sub : sequence) {
+        Positions next;
+        for (std::size_t p = 0; p <= s_.size(); ++p) {
+          if (positions.test(p)) {
+            next |= ends(sub, p);
+          }
+        }
+        positions = next;
+      }
+      alternatives |= positions;
+    }
+    res = alternatives;
+    return res;
+  }
+
+public:
+  // Return whether the rules reachable from 'root' are left-recursive.
+  static bool is_left_recursive(Rules const& rules, int const root) {
+    if (static_cast<std::size_t>(root) >= rules.size()) {
+      return false;                                                  // RETURN
+    }
+    std::vector<int> color(rules.size());
+    return is_left_recursive(rules, root, color);
+  }
+
+  explicit PositionMatcher(Rules const& rules)
+    : rules_{rules}, memo_(rules.size() * max_size), seen_(rules.size() * max_size, 0) {}
+
+  // Return whether rule 'root' matches exactly 's', which must be shorter
+  // than 'max_size'.
+  bool matches(std::string_view const s, int const root = 0) {
+    assert( s.size() < max_size );
+    s_ = s;
+    ++epoch_;
+    return ends(root, 0).test(s.size());
+  }
+};
+
+// Deterministic finite automaton over bytes, with a complete transition table
+// so that matching is one table load per byte. State 0 is the start state.
+class Dfa {
+public:
+  using State = std::uint32_t;
+
+private:
+  std::vector<State> next_; // 256 per state
+  std::vector<std::uint8_t> accept_;
+
+public:
+  Dfa(std::vector<State> next, std::vector<std::uint8_t> accept)
+    : next_{std::move(next)}, accept_{std::move(accept)} {
+    assert( next_.size() == 256 * accept_.size() );
+  }
+
+  std::size_t states() const {
+    return accept_.size();
+  }
+
+  bool matches(std::string_view const s) const {
+    State state = 0;
+    for (auto const c : s) {
+      state = next_[state * 256 + static_cast<unsigned char>(c)];
+    }
+    return accept_[state];
+  }
+};
+
+// Compiler from non-recursive rules to a minimized DFA. Every rule is lowered
+// bottom-up into a minimized automaton over the classes of bytes used as
+// terminals (class 0 being any other byte): the automata of its sub-rules are
+// chained into an NFA, which is determinized then minimized.
+class GrammarCompiler {
+  struct Automaton { // complete, over 'symbols_' classes, start at 0
+    std::vector<std::uint32_t> next;
+    std::vector<bool> accept;
+  };
+
+  struct Nfa {
+    std::vector<std::vector<std::pair<std::size_t, std::uint32_t>>> edges;
+    std::vector<std::vector<std::uint32_t>> epsilon;
+    std::vector<bool> accept;
+
+    std::uint32_t add_state() {
+      edges.emplace_back();
+      epsilon.emplace_back();
+      accept.push_back(false);
+      return static_cast<std::uint32_t>(accept.size() - 1);
+    }
+  };
+
+  Rules const& rules_;
+  std::array<std::uint8_t, 256> classes_{};
+  std::size_t symbols_ = 1;
+  std::vector<std::optional<Automaton>> memo_;
+
+  // Embed 'a' in 'nfa', leaving out its dead states, and return the offset.
+  std::uint32_t embed(Nfa& nfa, Automaton const& a) const {
+    auto const n = a.accept.size();
+    auto const offset = static_cast<std::uint32_t>(nfa.accept.size());
+    for (std::size_t i = 0; i < n; ++i) {
+      nfa.add_state();
+      nfa.accept.back() = a.accept[i];
+    }
+    for (std::size_t i = 0; i < n; ++i) {
+      for (std::size_t c = 0; c < symbols_; ++c) {
+        auto const to = a.next[i * symbols_ + c];
+        if (!is_dead(a, to)) {
+          nfa.edges[offset + i].emplace_back(c, offset + to);
+        }
+      }
+    }
+    return offset;
+  }
+
+  bool is_dead(Automaton const& a, std::uint32_t const s) const {
+    if (a.accept[s]) {
+      return false;                                                  // RETURN
+    }
+    for (std::size_t c = 0; c < symbols_; ++c) {
+      if (a.next[s * symbols_ + c] != s) {
+        return false;                                                // RETURN
+      }
+    }
+    return true;
+  }
+
+  void closure(Nfa const& nfa, std::vector<std::uint32_t>& set) const {
+    for (std::size_t i = 0; i < set.size(); ++i) {
+      for (auto const to : nfa.epsilon[set[i]]) {
+        if (std::find(begin(set), end(set), to) == end(set)) {
+          set.push_back(to);
+        }
+      }
+    }
+    std::sort(begin(set), end(set));
+  }
+
+  Automaton determinize(Nfa const& nfa, std::uint32_t const start) const {
+    Automaton res;
+    std::map<std::vector<std::uint32_t>, std::uint32_t> ids;
+    std::vector<std::vector<std::uint32_t>> sets{{start}};
+    closure(nfa, sets.front());
+    ids.emplace(sets.front(), 0);
+    for (std::size_t i = 0; i < sets.size(); ++i) {
+      auto const set = sets[i];
+      res.accept.push_back(std::any_of(begin(set), end(set), [&](auto const s) {
+        return nfa.accept[s];
+      }));
+      for (std::size_t c = 0; c < symbols_; ++c) {
+        std::vector<std::uint32_t> to;
+        for (auto const s : set) {
+          for (auto const& [symbol, t] : nfa.edges[s]) {
+            if (symbol == c && std::find(begin(to), end(to), t) == end(to)) {
+              to.push_back(t);
+            }
+          }
+        }
+        closure(nfa, to);
+        auto const [it, inserted] = ids.emplace(to, static_cast<std::uint32_t>(sets.size()));
+        if (inserted) {
+          sets.push_back(to);
+        }
+        res.next.push_back(it->second);
+      }
+    }
+    return res;
+  }
+
+  // Moore's partition refinement; the start state stays 0.
+  Automaton minimize(Automaton const& a) const {
+    auto const n = a.accept.size();
+    std::vector<std::uint32_t> block(n);
+    for (std::size_t i = 0; i < n; ++i) {
+      block[i] = a.accept[i];
+    }
+    for (std::size_t blocks = 0;;) {
+      std::map<std::vector<std::uint32_t>, std::uint32_t> ids;
+      std::vector<std::uint32_t> refined(n);
+      for (std::size_t i = 0; i < n; ++i) {
+        std::vector<std::uint32_t> signature{block[i]};
+        for (std::size_t c = 0; c < symbols_; ++c) {
+          signature.push_back(block[a.next[i * symbols_ + c]]);
+        }
+        refined[i] = ids.emplace(signature, static_cast<std::uint32_t>(ids.size())).first->second;
+      }
+      block = std::move(refined);
+      if (ids.size() == blocks) {
+        break;                                                       // BREAK
+      }
+      blocks = ids.size();
+    }
+    // Renumber by order of first appearance, so that the start state is 0.
+    std::vector<std::uint32_t> id(n, ~std::uint32_t{0});
+    std::uint32_t count = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      if (id[block[i]] == ~std::uint32_t{0}) {
+        id[block[i]] = count++;
+      }
+    }
+    Automaton res;
+    res.next.resize(count * symbols_);
+    res.accept.resize(count);
+    for (std::size_t i = 0; i < n; ++i) {
+      auto const s = id[block[i]];
+      res.accept[s] = a.accept[i];
+      for (std::size_t c = 0; c < symbols_; ++c) {
+        res.next[s * symbols_ + c] = id[block[a.next[i * symbols_ + c]]];
+      }
+    }
+    return res;
+  }
+
+  Automaton const& lower(int const i) {
+    auto& memo = memo_[static_cast<std::size_t>(i)];
+    if (memo) {
+      return *memo;                                                  // RETURN
+    }
+    auto const& rule = rules_[static_cast<std::size_t>(i)];
+    Nfa nfa;
+    auto const start = nfa.add_state();
+    if (rule.is_terminal()) {
+      auto const accept = nfa.add_state();
+      nfa.accept[accept] = true;
+      nfa.edges[start].emplace_back(classes_[static_cast<unsigned char>(rule.terminal())], accept);
+    }
+    else {
+      for (auto const& sequence : rule.alternatives()) {
+        auto last = nfa.add_state();
+        nfa.epsilon[start].push_back(last);
+        for (auto const r : sequence) {
+          auto const& a = lower(r);
+          auto const offset = embed(nfa, a);
+          nfa.epsilon[last].push_back(offset);
+          last = nfa.add_state();
+          for (std::uint32_t s = 0; s < a.accept.size(); ++s) {
+            if (nfa.accept[offset + s]) {
+              nfa.accept[offset + s] = false;
+              nfa.epsilon[offset + s].push_back(last);
+            }
+          }
+        }
+        nfa.accept[last] = true;
+      }
+    }
+    memo = minimize(determinize(nfa, start));
+    return *memo;
+  }
+
+  bool is_recursive(int const i, std::vector<int>& color) const { // 1: open, 2: done
+    auto& c = color[static_cast<std::size_t>(i)];
+    if (c != 0) {
+      return c == 1;                                                 // RETURN
+    }
+    c = 1;
+    auto const& rule = rules_[static_cast<std::size_t>(i)];
+    if (!rule.is_terminal()) {
+      for (auto const& sequence : rule.alternatives()) {
+        for (auto const r : sequence) {
+          if (is_recursive(r, color)) {
+            return true;                                             // RETURN
+          }
+        }
+      }
+    }
+    c = 2;
+    return false;
+  }
+
+public:
+  explicit GrammarCompiler(Rules const& rules) : rules_{rules}, memo_(rules.size()) {
+    for (auto const& rule : rules_) {
+      auto const c = static_cast<unsigned char>(rule.terminal());
+      if (rule.is_terminal() && classes_[c] == 0) {
+        classes_[c] = static_cast<std::uint8_t>(symbols_++);
+      }
+    }
+  }
+
+  // Return the minimized DFA matching exactly the messages matched by rule
+  // 'root', or nothing if the rules reachable from 'root' are recursive.
+  std::optional<Dfa> compile(int const root) {
+    std::vector<int> color(rules_.size());
+    if (static_cast<std::size_t>(root) >= rules_.size() || is_recursive(root, color)) {
+      return std::nullopt;                                           // RETURN
+    }
+    auto const& a = lower(root);
+    std::vector<Dfa::State> next(a.accept.size() * 256);
+    std::vector<std::uint8_t> accept(a.accept.size());
+    for (std::size_t s = 0; s < a.accept.size(); ++s) {
+      accept[s] = a.accept[s];
+      for (std::size_t c = 0; c < 256; ++c) {
+        next[s * 256 + c] = a.next[s * symbols_ + classes_[c]];
+      }
+    }
+    return Dfa{std::move(next), std::move(accept)};
+  }
+};
+
+// Return the number of 'messages' matched by 'dfa', sharding the messages
+// across the thread pool when there are enough of them.
+std::size_t count_matches(Dfa const& dfa, std::vector<std::string_view> const& messages) {
+  auto const matches = [&](std::size_t const i) { return std::size_t{dfa.matches(messages[i])}; };
+  if (messages.size() < 1024) {
+    std::size_t res = 0;
+    for (std::size_t i = 0; i < messages.size(); ++i) {
+      res += matches(i);
+    }
+    return res;                                                       // RETURN
+  }
+  return aoc::parallel_reduce(std::size_t{0}, messages.size(), std::size_t{0}, matches, std::plus<>{});
+}
+
+// Earley recognizer for any context-free rules, recursive ones included.
+// Rules are flattened into productions; the chart
+// (one item set per position) and the duplicate filter keep their memory from
+// one message to the next.
+class EarleyMatcher {
+  static auto constexpr terminal = std::uint32_t{1} << 31;
+
+  struct Production {
+    std::uint32_t lhs;
+    std::uint32_t first; // symbols in [first, first + size)
+    std::uint32_t size;
+    std::uint32_t dotted; // index of the (production, dot = 0) item
+  };
+
+  struct Item {
+    std::uint32_t production;
+    std::uint32_t dot;
+    std::uint32_t origin;
+  };
+
+  std::vector<Production> productions_;
+  std::vector<std::uint32_t> symbols_; // nonterminal, or 'terminal | byte'
+  std::vector<std::vector<std::uint32_t>> by_lhs_;
+  std::vector<bool> nullable_;
+  std::uint32_t root_;
+  std::uint32_t dotted_ = 0;
+
+  std::vector<std::vector<Item>> chart_;
+  std::vector<std::uint64_t> seen_; // by (dotted item, origin)
+  std::uint64_t epoch_ = 0;
+
+  std::uint64_t& seen(Item const item) {
+    return seen_[(productions_[item.production].dotted + item.dot) * chart_.size() + item.origin];
+  }
+
+  void add(std::size_t const j, Item const item) {
+    auto& stamp = seen(item);
+    if (stamp != epoch_) {
+      stamp = epoch_;
+      chart_[j].push_back(item);
+    }
+  }
+
+public:
+  EarleyMatcher(Rules const& rules, int const root) {
+    by_lhs_.resize(rules.size());
+    for (std::uint32_t i = 0; i < rules.size(); ++i) {
+      auto const& rule = rules[i];
+      auto const add_production = [&](auto const& sequence) {
+        productions_.push_back({i, static_cast<std::uint32_t>(symbols_.size()),
+                                static_cast<std::uint32_t>(sequence.size()), dotted_});
+        dotted_ += static_cast<std::uint32_t>(sequence.size()) + 1;
+        by_lhs_[i].push_back(static_cast<std::uint32_t>(productions_.size() - 1));
+      };
+      if (rule.is_terminal()) {
+        add_production(std::array{0});
+        symbols_.push_back(terminal | static_cast<unsigned char>(rule.terminal()));
+        continue;                                                  // CONTINUE
+      }
+      for (auto const& sequence : rule.alternatives()) {
+        add_production(sequence);
+        for (auto const r : sequence) {
+          symbols_.push_back(static_cast<std::uint32_t>(r));
+        }
+      }
+    }
+    root_ = static_cast<std::uint32_t>(root);
+    nullable_.resize(rules.size());
+    for (bool changed = true; changed; ) { // fixpoint
+      changed = false;
+      for (auto const& p : productions_) {
+        if (!nullable_[p.lhs]
+            && std::all_of(&symbols_[p.first], &symbols_[p.first] + p.size, [&](auto const s) {
+                 return !(s & terminal) && nullable_[s];
+               })) {
+          nullable_[p.lhs] = changed = true;
+        }
+      }
+    }
+  }
+
+  bool matches(std::string_view const s) {
+    auto const n = s.size();
+    if (chart_.size() < n + 1) {
+      chart_.resize(n + 1);
+      seen_.assign(dotted_ * chart_.size(), 0);
+      epoch_ = 0;
+    }
+    for (std::size_t j = 0; j <= n; ++j) {
+      chart_[j].clear();
+    }
+    ++epoch_;
+    for (auto const p : by_lhs_[root_]) {
+      add(0, {p, 0, 0});
+    }
+    for (std::size_t j = 0; j <= n; ++j) {
+      if (j > 0) { // register the scanned items, all distinct, for the filter
+        ++epoch_;
+        for (auto const item : chart_[j]) {
+          seen(item) = epoch_;
+        }
+      }
+      for (std::size_t k = 0; k < chart_[j].size(); ++k) {
+        auto const item = chart_[j][k];
+        auto const& p = productions_[item.production];
+        if (item.dot < p.size) {
+          auto const symbol = symbols_[p.first + item.dot];
+          if (symbol & terminal) { // scan
+            if (j < n && static_cast<unsigned char>(s[j]) == (symbol & ~terminal)) {
+              chart_[j + 1].push_back({item.production, item.dot + 1, item.origin});
+            }
+          }
+          else { // predict
+            for (auto const q : by_lhs_[symbol]) {
+              add(j, {q, 0, static_cast<std::uint32_t>(j)});
+            }
+            if (nullable_[symbol]) {
+              add(j, {item.production, item.dot + 1, item.origin});
+            }
+          }
+        }
+        else { // complete
+          for (std::size_t l = 0; l < chart_[item.origin].size(); ++l) {
+            auto const waiting = chart_[item.origin][l];
+            auto const& w = productions_[waiting.production];
+            if (waiting.dot < w.size && symbols_[w.first + waiting.dot] == p.lhs) {
+              add(j, {waiting.production, waiting.dot + 1, waiting.origin});
+            }
+          }
+        }
+      }
+    }
+    return std::any_of(begin(chart_[n]), end(chart_[n]), [&](auto const& item) {
+      auto const& p = productions_[item.production];
+      return p.lhs == root_ && item.dot == p.size && item.origin == 0;
+    });
+  }
+};
+
+// Return the number of messages in 'text' matched by rule 0, where the rules
+// listed in 'patches' replace the ones in 'text'.
+auto general_solve(std::string_view text, std::pmr::memory_resource* const resource,
+                   iMap<std::string_view> const& patches = {})
 {
-  auto const rules = solve_rules(parse_rules(text));
-  auto const zero = rules.at(0);
+  auto raw = parse_rules(text, resource);
+  for (auto const& [i, s] : patches) {
+    raw[i] = s;
+  }
+  auto const rules = solve_rules(raw, resource);
+  EarleyMatcher matcher{rules, 0};
   auto res = 0;
-  while (!text.empty()) { // all_of
-    auto const line = fetch_line(text);
-    res += zero.matches_exactly(line, rules);
+  for (auto const line : aoc::Lines{text}) { // count_if
+    res += matcher.matches(line);
   }
   return res;
 }
 
-auto hack_solve(std::string_view text)
+// Return the number of messages in 'text' matched by rule 0, where the rules
+// listed in 'patches' replace the ones in 'text', with the fastest matcher
+// handling them: a DFA if they are not recursive, and else memoized positions
+// for the short messages unless they are left-recursive, and Earley for the
+// others.
+auto parse_solve(std::string_view text, std::pmr::memory_resource* const resource,
+                 iMap<std::string_view> const& patches = {})
 {
-  auto const rules = solve_rules(parse_rules(text));
-  auto const _42 = rules.at(42);
-  auto const _31 = rules.at(31);
-  auto res = 0;
-  while (!text.empty()) { // all_of
-    auto line = fetch_line(text);
-    auto const f = _42.matches_n(line, rules);
-    auto const t = _31.matches_n(line, rules);
-    auto matches = f > 1 && t > 0 && t < f && line.empty();
-    if (matches) ++res;
+  auto raw = parse_rules(text, resource);
+  for (auto const& [i, s] : patches) {
+    raw[i] = s;
   }
-  return res;
+  auto const rules = solve_rules(raw, resource);
+  std::vector<std::string_view> messages;
+  for (auto const line : aoc::Lines{text}) {
+    messages.push_back(line);
+  }
+  if (auto const dfa = GrammarCompiler{rules}.compile(0)) {
+    return static_cast<int>(count_matches(*dfa, messages));          // RETURN
+  }
+  EarleyMatcher long_matcher{rules, 0};
+  if (PositionMatcher::is_left_recursive(rules, 0)) {
+    return static_cast<int>(std::count_if(begin(messages), end(messages), [&](auto const m) {
+      return long_matcher.matches(m);
+    }));                                                              // RETURN
+  }
+  PositionMatcher short_matcher{rules};
+  return static_cast<int>(std::count_if(begin(messages), end(messages), [&](auto const m) {
+    return m.size() < PositionMatcher::max_size ? short_matcher.matches(m)
+                                                : long_matcher.matches(m);
+  }));
 }
 
 //////////////////////////////////////////////////////////////////////
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(0: 4 1 5
+[[maybe_unused]] auto const test = R"(0: 4 1 5
 1: 2 3 | 3 2
 2: 4 4 | 5 5
 3: 4 5 | 5 4
@@ -176,7 +695,7 @@ aaabbb
 aaaabbb
 )";
 
-auto const test2 = R"(42: 9 14 | 10 1
+[[maybe_unused]] auto const test2 = R"(42: 9 14 | 10 1
 9: 14 27 | 1 26
 10: 23 14 | 28 1
 1: "a"
@@ -814,10 +1333,41 @@ bbaaababbaabbbababaaaaabbababaabaaaabbaaababbaaaaaaaababaaabbaab
 aababbbabababbbaabbbabba
 )";
 
-auto const res1 = parse_solve(input);
-fmt::print("res to part 1 is {}\n", res1);
+[[maybe_unused]] auto const left_recursive = R"(0: 0 1 | 1
+1: "a"
+
+a
+aa
+aaa
+b
+)";
 
-auto const res2 = hack_solve(input);
+auto const patches = iMap<std::string_view>{{8, "42 | 42 8"}, {11, "42 31 | 42 11 31"}};
+{
+  auto arena = aoc::Arena{};
+  assert(( parse_solve(test, &arena) == 2 ));
+  assert(( general_solve(test, &arena) == 2 ));
+  assert(( parse_solve(test2, &arena) == 3 ));
+  assert(( parse_solve(test2, &arena, patches) == 12 )); // memoized positions
+  assert(( general_solve(test2, &arena, patches) == 12 ));
+  assert(( parse_solve(left_recursive, &arena) == 3 ));  // Earley
+  assert(( general_solve(left_recursive, &arena) == 3 ));
+}
+
+auto const text = aoc::input(argc, argv, input);
+int res1 = 0, res2 = 0;
+aoc::parallel_invoke( // an arena per part, arenas being bound to one thread
+  [&] {
+    auto arena = aoc::Arena{};
+    auto const part = aoc::Probe{"part 1"};
+    res1 = parse_solve(text, &arena);
+  },
+  [&] {
+    auto arena = aoc::Arena{};
+    auto const part = aoc::Probe{"part 2"};
+    res2 = parse_solve(text, &arena, patches);
+  });
+fmt::print("res to part 1 is {}\n", res1);
 fmt::print("res to part 2 is {}\n", res2);
 
 }
\ No newline at end of file
@@ -4,76 +4,44 @@
 
 #include <algorithm>
 #include <cassert>
+#include <string_view>
 #include <vector>
 #include <fmt/core.h>
 
-template<class T>
-class Matrix
-{
-  std::vector<T> data_;
-  std::size_t cols_;
-public:
-  Matrix(std::size_t rows, std::size_t cols, T const& value)
-  : data_(rows*cols, value)
-  , cols_{cols}
-  { }
+#include "AoC_alloc.hpp"
+#include "AoC_grid.hpp"
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_probe.hpp"
 
-  template<class It>
-  void add_row(It first, It last) {
-    assert(std::distance(first, last) == cols_);
-    auto const idx = data_.size();
-    data_.resize(data_.size() + cols_);
-    std::copy(first, last, std::next(begin(data_), idx));
-  }
-
-  std::size_t rows() const noexcept { return data_.size() / cols_; }
-  std::size_t cols() const noexcept { return cols_; }
-
-  T at(std::size_t row, std::size_t col) const noexcept {
-    return data_[row*cols_ + col];
-  }
-
-  std::size_t count(T const& value) const noexcept {
-    return std::count(begin(data_), end(data_), value);
-  }
-};
-
-std::size_t get_cols(char const* s) {
-  std::size_t res = 0;
-  while (*s != '\0' && *s++ != '\n') {
-    ++res;
-  }
-  return res;
-}
-
-Matrix<bool> parse_trees(char const* s) {
+aoc::Grid<bool> parse_trees(std::string_view const text) {
   auto constexpr tree = '#';
-  auto constexpr clear = '.';
-  auto const cols = get_cols(s);
-  Matrix<bool> res(0, cols, false);
-  std::vector<bool> buffer_(cols, false);
-  while (*s != '\0') {
-    if (*s == '\n') ++s;
-    std::transform(s, s + cols, begin(buffer_), [&](char const c) {
-      return c == tree;
-    });
-    res.add_row(begin(buffer_), end(buffer_));
-    s += cols;
+  aoc::Lines const lines{text};
+  auto const cols = (*lines.begin()).size();
+  aoc::Grid<bool> res(0, cols);
+  res.reserve(text.size() / (cols + 1) + 1);
+  for (auto const line : lines) {
+    res.add_row(false);
+    auto const r = static_cast<std::ptrdiff_t>(res.rows() - 1);
+    for (std::size_t c = 0; c < cols; ++c) {
+      if (line[c] == tree) res.set(r, static_cast<std::ptrdiff_t>(c), true);
+    }
   }
   return res;
 }
 
-std::size_t slope_trees(Matrix<bool> const& m, std::size_t h, std::size_t v) {
+std::size_t slope_trees(aoc::Grid<bool> const& m, std::size_t h, std::size_t v) {
+  auto const no_alloc = aoc::NoAllocation{"slope_trees"};
   std::size_t res = 0;
   for (std::size_t i = 0, j = 0; i < m.rows(); i += v, j = (j + h) % m.cols()) {
-    res += m.at(i, j);
+    res += m.at(static_cast<std::ptrdiff_t>(i), static_cast<std::ptrdiff_t>(j));
   }
   return res;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(..##.......
+[[maybe_unused]] auto const test = R"(..##.......
 #...#...#..
 .#....#..#.
 ..#.#...#.#
@@ -409,10 +377,13 @@ auto const input = R"(......#...........#...#........
 ..#.....................#......
 ..#..#...##...#.##........#....)";
 
-auto const m = parse_trees(input);
+auto const text = aoc::input(argc, argv, input);
+auto probe = aoc::Probe{"parse"};
+auto const m = parse_trees(text);
 
 fmt::print("m is {} x {} with {} trees\n", m.rows(), m.cols(), m.count(true));
 
+probe.next("part 2");
 auto const r11 = slope_trees(m, 1, 1);
 fmt::print("trees encountered by moving ({}, {}): {}\n", 1, 1, r11);
 auto const r31 = slope_trees(m, 3, 1);
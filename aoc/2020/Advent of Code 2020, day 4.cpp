@@ -3,47 +3,44 @@
 // Godbolt link: https://godbolt.org/z/aha3Gc
 
 #include <algorithm>
-#include <charconv>
+#include <memory_resource>
 #include <unordered_map>
 #include <string>
 #include <string_view>
 #include <vector>
 #include <fmt/core.h>
 
-bool is_digit(char const c) noexcept {
-  return '0' <= c && c <= '9';
-}
+#include "AoC_arena.hpp"
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_probe.hpp"
 
 bool is_hex(char const c) noexcept {
-  return is_digit(c)
-      || 'a' <= c && c <= 'f';
+  return aoc::is_digit(c)
+      || ('a' <= c && c <= 'f');
 }
 
 bool is_valid_byr(std::string_view s) noexcept {
   int y;
-  auto const [_, ec] = std::from_chars(s.data(), s.data()+s.size(), y);
-  return ec == std::errc{} && 1920 <= y && y <= 2002;
+  return aoc::parse_int(s, y) && 1920 <= y && y <= 2002;
 }
 
 bool is_valid_iyr(std::string_view s) noexcept {
   int y;
-  auto const [_, ec] = std::from_chars(s.data(), s.data()+s.size(), y);
-  return ec == std::errc{} && 2010 <= y && y <= 2020;
+  return aoc::parse_int(s, y) && 2010 <= y && y <= 2020;
 }
 
 bool is_valid_eyr(std::string_view s) noexcept {
   int y;
-  auto const [_, ec] = std::from_chars(s.data(), s.data()+s.size(), y);
-  return ec == std::errc{} && 2020 <= y && y <= 2030;
+  return aoc::parse_int(s, y) && 2020 <= y && y <= 2030;
 }
 
 bool is_valid_hgt(std::string_view s) noexcept {
   int h;
-  auto const last = s.data() + s.size();
-  auto const [p, ec] = std::from_chars(s.data(), last, h);
-  auto const unit = std::string_view(p, last);
-  return unit == "cm" && 150 <= h && h <= 193
-      || unit == "in" &&  59 <= h && h <= 76;
+  if (!aoc::parse_int(s, h)) return false;
+  auto const unit = s;
+  return (unit == "cm" && 150 <= h && h <= 193)
+      || (unit == "in" &&  59 <= h && h <= 76);
 }
 
 bool is_valid_hcl(std::string_view s) noexcept {
@@ -64,23 +61,21 @@ bool is_valid_ecl(std::string_view s) noexcept {
 
 bool is_valid_pid(std::string_view s) noexcept {
   return s.size() == 9
-      && std::all_of(begin(s), end(s), is_digit);
+      && std::all_of(begin(s), end(s), aoc::is_digit);
 }
 
 class Passport
 {
-  std::unordered_map<std::string, std::string> fields_;
+  std::pmr::unordered_map<std::pmr::string, std::pmr::string> fields_;
 public:
-  explicit Passport(std::string_view s) {
+  Passport(std::string_view s, std::pmr::memory_resource* const resource) : fields_{resource} {
     for (auto first = begin(s); first != end(s); ) {
       auto const mid = std::find(first, end(s), ':');
-      std::string key(first, mid);
       auto const last = std::find_if(std::next(mid), end(s), [](char const c) {
         return c == ' ' || c == '\n';
       });
-      std::string value(std::next(mid), last);
-      fields_.emplace(std::move(key), std::move(value));
-      first = std::next(last);
+      fields_.emplace(std::string_view(first, mid), std::string_view(std::next(mid), last));
+      first = last == end(s) ? last : std::next(last);
     }  
   }
 
@@ -100,40 +95,30 @@ bool is_valid(Passport const& passport) noexcept {
   return passport.is_valid();
 }
 
-Passport getPassport(char const* &s) {
-  auto first = s;
-  auto last = first;
-  auto is_newline = false;
-  for(;;) {
-    if (*s == '\0') break;
-    if (*s == '\n') {
-        ++s;
-        if (is_newline) break;
-        is_newline = true;
-        ++last;
-    }
-    else {
-      ++s;
-      is_newline = false;
-      ++last;
+// Passports are groups of lines separated by blank lines.
+std::pmr::vector<Passport> parse(std::string_view const text, std::pmr::memory_resource* const resource) {
+  auto const no_alloc = aoc::NoAllocation{"parse"};
+  std::pmr::vector<Passport> res{resource};
+  char const* first = nullptr;
+  char const* last = nullptr;
+  for (auto const line : aoc::Lines{text}) {
+    if (line.empty()) {
+      if (first) res.emplace_back(std::string_view(first, last), resource);
+      first = nullptr;
+      continue;
     }
+    if (!first) first = line.data();
+    last = line.data() + line.size();
   }
-  return Passport(std::string_view{first, last});
-}
-
-std::vector<Passport> parse(char const* s) {
-  std::vector<Passport> res;
-  while (*s != '\0') {
-    res.push_back(getPassport(s));
-  }
+  if (first) res.emplace_back(std::string_view(first, last), resource);
   return res;
 }
 
 //////////////////////////////////////////////////////////////////////
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(ecl:gry pid:860033327 eyr:2020 hcl:#fffffd
+[[maybe_unused]] auto const test = R"(ecl:gry pid:860033327 eyr:2020 hcl:#fffffd
 byr:1937 iyr:2017 cid:147 hgt:183cm
 
 iyr:2013 ecl:amb cid:350 eyr:2023 pid:028048884
@@ -1181,7 +1166,11 @@ ecl:#a16ec8 pid:187cm hcl:z iyr:2029 hgt:170
 byr:2008
 )";
 
-auto const v = parse(input);
+auto const text = aoc::input(argc, argv, input);
+auto arena = aoc::Arena{};
+auto probe = aoc::Probe{"parse"};
+auto const v = parse(text, &arena);
+probe.next("part 2");
 
 auto const res = std::count_if(begin(v), end(v), is_valid);
 fmt::print("valid passports: {} on {}\n", res, v.size());
@@ -3,10 +3,15 @@
 
 #include <algorithm>
 #include <array>
+#include <string_view>
 #include <vector>
 #include <utility>
 #include <fmt/core.h>
 
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_probe.hpp"
+
 std::pair<int, int> row_col(char const* f, char const* m, char const* l) {
   int row = 0;
   for (; f != m; ++f) {
@@ -27,21 +32,21 @@ int get_id(std::pair<int, int> const& p) {
   return (1 << ColChars) * r + c;
 }
 
-std::vector<int> parse(char const* s) {
+std::vector<int> parse(std::string_view const text) {
   std::vector<int> res;
-  while (*s != '\0') {
+  for (auto const line : aoc::Lines{text}) {
+    auto const s = line.data();
     auto constexpr lineWidth = RowChars + ColChars;
     auto const id = get_id(row_col(s, s+RowChars, s+lineWidth));
     fmt::print("id is {}\n", id);
     res.insert(std::lower_bound(begin(res), end(res), id), id);
-    s += lineWidth+1;
   }
   return res;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(BFFFBBFRRR
+[[maybe_unused]] auto const test = R"(BFFFBBFRRR
 FFFBBBFRRR
 BBFFBBFRLL
 )";
@@ -891,7 +896,10 @@ FBBFFFBLRR
 BFBFBFFRRL
 )";
 
-auto const ids = parse(input);
+auto const text = aoc::input(argc, argv, input);
+auto probe = aoc::Probe{"parse"};
+auto const ids = parse(text);
+probe.next("part 2");
 auto const res = *std::adjacent_find(begin(ids), end(ids),
   [](int lhs, int rhs) {
     return rhs - lhs != 1;
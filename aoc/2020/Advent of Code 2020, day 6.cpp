@@ -6,6 +6,10 @@
 #include <string_view>
 #include <fmt/core.h>
 
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_probe.hpp"
+
 std::pair<std::array<int, 26>, int> answers(std::string_view const group) {
   std::array<int, 26> freq{};
   int n = 0;
@@ -14,7 +18,7 @@ std::pair<std::array<int, 26>, int> answers(std::string_view const group) {
         ++n;
     }
     else {
-      ++freq[c-'a'];
+      ++freq[static_cast<std::size_t>(c - 'a')];
     }
   }
   return {freq, n};
@@ -24,38 +28,36 @@ int count_answers(std::string_view const group) {
   fmt::print("group is |{}|\n", group);
   auto const [freq, n_] = answers(group);
   auto const n = n_; // non-capturable binding...
-  return std::count_if(begin(freq), end(freq), [&](int const f){
+  return static_cast<int>(std::count_if(begin(freq), end(freq), [&](int const f){
     return f == n;
-  });
+  }));
 }
 
-std::string_view get_group(char const*& s) {
-  auto const first = s;
-  auto is_newline = false;
-  while (*s != '\0') {
-    auto const c = *s++;
-    if (c == '\n') {
-      if (is_newline) break;
-      is_newline = true;
-    }
-    else {
-      is_newline = false;
-    }
-  }
-  return std::string_view(first, *s == '\0' ? s : s-1);
-}
-
-int total_count(char const* s) {
+// Groups are runs of lines separated by blank lines, each one keeping the
+// newline of its lines.
+int total_count(std::string_view const text) {
+  auto const group = [&](char const* first, char const* last) {
+    return std::string_view(first, std::min(last + 1, text.data() + text.size()));
+  };
   int res = 0;
-  while (*s != '\0') {
-    res += count_answers(get_group(s));
+  char const* first = nullptr;
+  char const* last = nullptr;
+  for (auto const line : aoc::Lines{text}) {
+    if (line.empty()) {
+      if (first) res += count_answers(group(first, last));
+      first = nullptr;
+      continue;
+    }
+    if (!first) first = line.data();
+    last = line.data() + line.size();
   }
+  if (first) res += count_answers(group(first, last));
   return res;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(abc
+[[maybe_unused]] auto const test = R"(abc
 
 a
 b
@@ -2264,7 +2266,9 @@ pvuafthmr
 dvpmwcyg
 )";
 
-auto const res = total_count(input);
+auto const text = aoc::input(argc, argv, input);
+auto probe = aoc::Probe{"part 2"};
+auto const res = total_count(text);
 
 fmt::print(">> total count is {}\n", res);
 
@@ -3,68 +3,58 @@
 
 #include <algorithm>
 #include <array>
+#include <memory_resource>
+#include <string>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <fmt/core.h>
 
-template<class It>
-int to_int(It first, It last) {
-  int res = 0;
-  for (auto it = first; it != last; ++it) {
-    res = res*10 + (*it - '0');
-  }
-  //fmt::print(stderr, "Converting to int '{}' -> {}\n", std::string_view(first, last), res);
-  return res;
-}
+#include "AoC_arena.hpp"
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_probe.hpp"
 
-std::pair<int, std::string> get_next(std::string_view& s) {
-  auto const is_digit = [](char const c) {
-    return '0' <= c && c <= '9';
-  };
-  auto const first = std::find_if(begin(s), end(s), is_digit);
-  auto const last = std::find_if_not(first, end(s), is_digit);
-  if (last == end(s)) {
-    s.remove_prefix(s.size());  
+std::pair<int, std::string_view> get_next(std::string_view& s) {
+  auto const i = aoc::fetch_int(s);
+  if (s.empty()) {
     return {-1, ""};
   }
-  auto const i = to_int(first, last);
-  s.remove_prefix(std::distance(begin(s), last)+1);
+  s.remove_prefix(1);
   auto const pos = s.find(" bag");
-  std::string dep(s.data(), pos);
+  auto const dep = s.substr(0, pos);
   s.remove_prefix(pos + 4);
   //fmt::print(stderr, "{} of {}\n", i, dep);
-  return {i, std::move(dep)};
+  return {i, dep};
 }
 
-using Map = std::unordered_map<std::string,
-  std::unordered_map<std::string, int>>;
+using Map = std::pmr::unordered_map<std::pmr::string,
+  std::pmr::unordered_map<std::pmr::string, int>>;
 
 void add_rules(std::string_view row, Map& map) {
-  auto const name = std::string(row.data(), row.find(" bags"));
-  auto& entry = map[name];
+  auto const name = row.substr(0, row.find(" bags"));
+  auto& entry = map.try_emplace(Map::key_type(name, map.get_allocator())).first->second;
   //fmt::print(stderr, "Adding rules for {}\n", name);
   while (!row.empty()) {
-      auto [i, dep] = get_next(row);
-      if (i != -1) entry.emplace(std::move(dep), i);
+      auto const [i, dep] = get_next(row);
+      if (i != -1) entry.emplace(dep, i);
   }
 }
 
-auto parse_rules(std::string_view text)
+auto parse_rules(std::string_view text, std::pmr::memory_resource* const resource)
 {
-  Map res;
-  while (!text.empty()) {
-    auto const pos = text.find('\n');
-    add_rules(text.substr(0, pos), res);
-    text.remove_prefix(pos+1);
+  auto const no_alloc = aoc::NoAllocation{"parse_rules"};
+  Map res{resource};
+  for (auto const line : aoc::Lines{text}) {
+    add_rules(line, res);
   }
   return res;
 }
 
-bool fill_contain(std::unordered_map<std::string, bool>& res,
+bool fill_contain(std::unordered_map<std::pmr::string, bool>& res,
                   Map const& rules,
-                  std::string const& target,
-                  std::string const& root)
+                  std::pmr::string const& target,
+                  std::pmr::string const& root)
 {
   if (!res.contains(root)) {
     auto const& deps = rules.at(root);
@@ -91,23 +81,23 @@ bool fill_contain(std::unordered_map<std::string, bool>& res,
 }
 
 auto can_contain(Map const& rules, std::string_view const s) {
-  std::unordered_map<std::string, bool> res;
+  std::unordered_map<std::pmr::string, bool> res;
   for (auto const& [name, _] : rules) {
-    fill_contain(res, rules, std::string(s), name);
+    fill_contain(res, rules, std::pmr::string(s), name);
   }
   return res;
 }
 
 int solve_1(Map const& rules, std::string_view const s) {
   auto const contain = can_contain(rules, s);
-  return std::count_if(begin(contain), end(contain), [](auto const& p) {
+  return static_cast<int>(std::count_if(begin(contain), end(contain), [](auto const& p) {
     return p.second == true;
-  });
+  }));
 }
 
-int count_( std::unordered_map<std::string, int>& cache,
+int count_( std::unordered_map<std::pmr::string, int>& cache,
             Map const& rules,
-            std::string const& s)
+            std::pmr::string const& s)
 {
   fmt::print("count for {}\n", s);
   if (!cache.contains(s)) {
@@ -121,13 +111,13 @@ int count_( std::unordered_map<std::string, int>& cache,
 }
 
 auto count(Map const& rules, std::string_view const s) {
-  std::unordered_map<std::string, int> cache;
-  return count_(cache, rules, std::string(s));
+  std::unordered_map<std::pmr::string, int> cache;
+  return count_(cache, rules, std::pmr::string(s));
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(light red bags contain 1 bright white bag, 2 muted yellow bags.
+[[maybe_unused]] auto const test = R"(light red bags contain 1 bright white bag, 2 muted yellow bags.
 dark orange bags contain 3 bright white bags, 4 muted yellow bags.
 bright white bags contain 1 shiny gold bag.
 muted yellow bags contain 2 shiny gold bags, 9 faded blue bags.
@@ -138,7 +128,7 @@ faded blue bags contain no other bags.
 dotted black bags contain no other bags.
 )";
 
-auto const test2 = R"(shiny gold bags contain 2 dark red bags.
+[[maybe_unused]] auto const test2 = R"(shiny gold bags contain 2 dark red bags.
 dark red bags contain 2 dark orange bags.
 dark orange bags contain 2 dark yellow bags.
 dark yellow bags contain 2 dark green bags.
@@ -743,7 +733,10 @@ bright purple bags contain 5 light lime bags, 1 pale gray bag, 1 faded turquoise
 vibrant maroon bags contain 5 vibrant lavender bags, 3 wavy black bags, 2 striped magenta bags, 2 pale green bags.
 )";
 
-auto const rules = parse_rules(input);
+auto const text = aoc::input(argc, argv, input);
+auto arena = aoc::Arena{};
+auto probe = aoc::Probe{"parse"};
+auto const rules = parse_rules(text, &arena);
 /*
 for (auto const& [name, deps] : rules) {
   fmt::print("{}: ", name);
@@ -754,6 +747,7 @@ for (auto const& [name, deps] : rules) {
 }
 */
 
+probe.next("part 2");
 auto const res = count(rules, "shiny gold");
 
 fmt::print(">> count is {}\n", res);
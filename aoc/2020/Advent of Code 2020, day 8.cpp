@@ -3,21 +3,17 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cassert>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <fmt/core.h>
 
-int to_signed_int(std::string_view const s) {
-  int res = 0;
-  for (auto it = std::next(begin(s)); it != end(s); ++it) {
-    res = res*10 + (*it - '0');
-  }
-  //fmt::print(stderr, "Converting to int '{}' -> {}\n", std::string_view(first, last), res);
-  if (s.front() == '-') res *= -1;
-  return res;
-}
+#include "AoC_input.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_pool.hpp"
+#include "AoC_probe.hpp"
 
 enum Instruction : char { Nop, Acc, Jmp };
 Instruction to_instruction(std::string_view const s) {
@@ -29,53 +25,73 @@ Instruction to_instruction(std::string_view const s) {
 
 std::pair<Instruction, int> parse_line(std::string_view const s) {
   auto const i = to_instruction(s.substr(0, 3));
-  auto const n = to_signed_int(s.substr(4)); 
+  auto const n = aoc::to_int(s.substr(4));
   return {i, n};
 }
 
 auto parse(std::string_view text)
 {
   std::vector<std::pair<Instruction, int>> res;
-  while (!text.empty()) {
-    auto const pos = text.find('\n');
-    res.push_back(parse_line(text.substr(0, pos)));
-    text.remove_prefix(pos+1);
+  for (auto const line : aoc::Lines{text}) {
+    res.push_back(parse_line(line));
   }
   return res;
 }
 
-std::pair<int, bool> get_acc(std::vector<std::pair<Instruction, int>> const& instructions) {
+// Return the accumulator when the program ends or first loops, and whether
+// it loops, with the instruction at 'flip', if any, flipped between 'Nop' and
+// 'Jmp'.
+std::pair<int, bool> get_acc(std::vector<std::pair<Instruction, int>> const& instructions,
+                             std::size_t const flip = std::size_t(-1)) {
   std::vector<bool> executed(instructions.size(), false);
   int res = 0;
   std::size_t idx = 0;
   while(idx < instructions.size() && !executed[idx]) {
     executed[idx] = true;
-    auto const [i, n] = instructions[idx];
+    auto [i, n] = instructions[idx];
+    if (idx == flip) {
+      i = i == Nop ? Jmp : Nop;
+    }
     switch (i) {
       case Nop: { ++idx; break; }
       case Acc: { res += n; ++idx; break; }
-      case Jmp: { idx += n; break; }
+      case Jmp: { idx += static_cast<std::size_t>(n); break; } // wraps back if n < 0
     }
   }
   return {res, idx < instructions.size()};
 }
 
+// Return the accumulator of the program terminating with the first
+// instruction possible flipped. The flips are tried in parallel, skipping
+// those after a flip already found to terminate.
 int get_acc_correction(std::vector<std::pair<Instruction, int>> const& instructions) {
-  auto instr = instructions;
-  for (auto& [i, _] : instr) {
-    if (i != Acc) {
-      i = i == Nop ? Jmp : Nop; // flip
-      auto const [n, is_loop] = get_acc(instr);
-      if (!is_loop) return n;
-      i = i == Nop ? Jmp : Nop; // flip back
-    }
+  using Flip = std::pair<std::size_t, int>; // index, accumulator
+  auto constexpr none = Flip{std::size_t(-1), 0};
+  std::atomic<std::size_t> found = none.first;
+  auto const res = aoc::parallel_reduce(std::size_t{0}, instructions.size(), none,
+    [&](std::size_t const f) {
+      if (instructions[f].first == Acc || f > found.load(std::memory_order_relaxed)) {
+        return none;                                                  // RETURN
+      }
+      auto const [n, is_loop] = get_acc(instructions, f);
+      if (is_loop) {
+        return none;                                                  // RETURN
+      }
+      auto first = found.load(std::memory_order_relaxed);
+      while (f < first && !found.compare_exchange_weak(first, f, std::memory_order_relaxed)) {
+      }
+      return Flip{f, n};
+    },
+    [](Flip const& lhs, Flip const& rhs) { return std::min(lhs, rhs); });
+  if (res.first == none.first) {
+    std::abort();
   }
-  std::abort();
+  return res.second;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
 
-auto const test = R"(nop +0
+[[maybe_unused]] auto const test = R"(nop +0
 acc +1
 jmp +4
 acc +3
@@ -700,12 +716,15 @@ acc +2
 jmp +1
 )";
 
-auto const instructions = parse(input);
+auto const text = aoc::input(argc, argv, input);
+auto probe = aoc::Probe{"parse"};
+auto const instructions = parse(text);
 
 // Part 1
 //auto const [res, is_loop] = get_acc(instructions);
 //assert( is_loop );
 
+probe.next("part 2");
 auto const res = get_acc_correction(instructions);
 
 fmt::print(">> acc is {}\n", res);
@@ -9,10 +9,13 @@
 #include <vector>
 #include <fmt/core.h>
 
+#include "AoC_input.hpp"
+#include "AoC_probe.hpp"
+
 using Int = std::int64_t; 
 
 bool is_valid(Int const n, std::unordered_set<Int> const& pool) {
-  return std::any_of(begin(pool), end(pool), [&](int const i) {
+  return std::any_of(begin(pool), end(pool), [&](Int const i) {
     return pool.contains(n - i);
   });
 }
@@ -20,10 +23,10 @@ bool is_valid(Int const n, std::unordered_set<Int> const& pool) {
 Int first_invalid(std::vector<Int> const& v, std::size_t const preamble) {
   std::unordered_set<Int> pool;
   std::copy_n(begin(v), preamble, std::inserter(pool, end(pool)));
-  for (auto it = std::next(begin(v), preamble); it != end(v); ++it) {
+  for (auto it = std::next(begin(v), static_cast<std::ptrdiff_t>(preamble)); it != end(v); ++it) {
     auto const i = *it;
     if (!is_valid(i, pool)) return i;
-    pool.erase(*std::prev(it, preamble));
+    pool.erase(*std::prev(it, static_cast<std::ptrdiff_t>(preamble)));
     pool.insert(i);
   }
   std::abort(); // no result
@@ -52,7 +55,7 @@ std::pair<Int, Int> get_range_boundaries(std::vector<Int> const& v, Int const n)
 
 //////////////////////////////////////////////////////////////////////
 
-int main() {
+int main(int argc, char* argv[]) {
 
 auto const test = std::vector<Int>
 { 35LL
@@ -1080,8 +1083,11 @@ auto const input = std::vector<Int>
 , 83267654028700LL
 };
 
-auto const i = first_invalid(input, 25);
-auto const [l, h] = get_range_boundaries(input, i);
+auto const numbers = argc > 1 ? aoc::numbers<Int>(aoc::input(argc, argv, {})) : input;
+auto probe = aoc::Probe{"part 1"};
+auto const i = first_invalid(numbers, 25);
+probe.next("part 2");
+auto const [l, h] = get_range_boundaries(numbers, i);
 fmt::print("first invalid is {}\n", i);
 fmt::print("weakness is {}, made from {} + {}\n", l + h, l, h);
 
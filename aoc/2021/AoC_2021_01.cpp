@@ -1,3 +1,75 @@
 #include "AoC_2021_01.hpp"
+#include "AoC_cpu.hpp"
 
-// This file is intentionally left blank.
\ No newline at end of file
+#ifdef AOC_HAS_TARGETS
+#include <immintrin.h>
+#endif
+
+#include <bit> // popcount
+
+namespace {
+
+using CountIncreases = std::size_t(*)(int const*, std::size_t) noexcept;
+
+std::size_t count_increases_generic(int const* const first, std::size_t const size) noexcept {
+  std::size_t count = 0;
+  for (std::size_t i = 1; i < size; ++i) { // count_if
+    count += first[i - 1] < first[i];
+  }
+  return count;
+}
+
+#ifdef AOC_HAS_TARGETS
+AOC_TARGET("avx2")
+std::size_t count_increases_avx2(int const* const first, std::size_t const size) noexcept {
+  // Each lane of 'acc' counts down by one per increase: a true comparison is
+  // all ones, i.e. -1.
+  auto acc = _mm256_setzero_si256();
+  std::size_t i = 1;
+  for (; i + 8 <= size; i += 8) {
+    auto const prev = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(first + i - 1));
+    auto const cur = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(first + i));
+    acc = _mm256_add_epi32(acc, _mm256_cmpgt_epi32(cur, prev));
+  }
+  auto sum = _mm_add_epi32(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4e));
+  sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xb1));
+  auto count = static_cast<std::size_t>(-static_cast<std::ptrdiff_t>(_mm_cvtsi128_si32(sum)));
+  for (; i < size; ++i) {
+    count += first[i - 1] < first[i];
+  }
+  return count;
+}
+
+AOC_TARGET("avx512f,popcnt")
+std::size_t count_increases_avx512(int const* const first, std::size_t const size) noexcept {
+  std::size_t count = 0;
+  std::size_t i = 1;
+  for (; i + 16 <= size; i += 16) {
+    auto const prev = _mm512_loadu_si512(first + i - 1);
+    auto const cur = _mm512_loadu_si512(first + i);
+    count += static_cast<std::size_t>(std::popcount(_mm512_cmpgt_epi32_mask(cur, prev)));
+  }
+  // The tail is one masked step: the lanes past the end compare equal.
+  if (i < size) {
+    auto const tail = static_cast<__mmask16>((1u << (size - i)) - 1);
+    auto const prev = _mm512_maskz_loadu_epi32(tail, first + i - 1);
+    auto const cur = _mm512_maskz_loadu_epi32(tail, first + i);
+    count += static_cast<std::size_t>(std::popcount(_mm512_mask_cmpgt_epi32_mask(tail, cur, prev)));
+  }
+  return count;
+}
+#else
+auto constexpr count_increases_avx2 = CountIncreases{nullptr};
+auto constexpr count_increases_avx512 = CountIncreases{nullptr};
+#endif
+
+constinit aoc::Kernel<CountIncreases> const kernel{
+  count_increases_generic, nullptr, count_increases_avx2, count_increases_avx512
+};
+
+} // namespace
+
+std::size_t aoc::detail::count_increases(int const* const first, std::size_t const size) noexcept {
+  return kernel(first, size);
+}
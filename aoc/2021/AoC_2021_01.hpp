@@ -13,15 +13,42 @@ namespace aoc {
 template <typename Range>
 std::size_t count_increases(Range const& measurements) noexcept;
 
+namespace detail {
+
+// Return the number of elements in '[first, first + size)' which are larger
+// than the previous element; vectorized for the processor it runs on.
+std::size_t count_increases(int const* first, std::size_t size) noexcept;
+
+} // namespace detail
 } // namespace aoc
 
 ///////////////////////////////////////////////////////////////////////////////
 // Template definitions
 ///////////////////////////////////////////////////////////////////////////////
-#include <iterator> // next
+#include <iterator>    // data, next, size
+#include <type_traits> // is_same, remove_cv, void_t
+#include <utility>     // declval
+
+namespace aoc::detail {
+
+// Whether 'Range' stores contiguous 'int's, e.g. 'std::vector<int>'.
+template <typename Range, typename = void>
+struct is_contiguous_int_range : std::false_type {};
+
+template <typename Range>
+struct is_contiguous_int_range<Range, std::void_t<decltype(std::size(std::declval<Range const&>())),
+                                                  decltype(std::data(std::declval<Range const&>()))>>
+  : std::is_same<std::remove_cv_t<std::remove_pointer_t<decltype(std::data(std::declval<Range const&>()))>>,
+                 int> {};
+
+} // namespace aoc::detail
 
 template <typename Range>
 std::size_t aoc::count_increases(Range const& measurements) noexcept {
+  if constexpr (detail::is_contiguous_int_range<Range>::value) {
+    return detail::count_increases(std::data(measurements),
+                                   static_cast<std::size_t>(std::size(measurements))); // RETURN
+  }
   if (cbegin(measurements) == cend(measurements)) {
     return 0;                                                         // RETURN
   }
@@ -2,21 +2,500 @@
 // File aoc.m.hpp
 ///////////////////////////////////////////////////////////////////////////////
 // This is an application running Advent of Code puzzles.
+//
+// Usage: aoc [--isa=<name>] [--format=text|json|csv]
+//            [--jobs=<n>] [--budget=<seconds>] [--threads=<n>]
+//            [--no-cache | --verify] [--answers]
+//            [--scaling[=<seconds>]] [--seed=<n>] [<year>[/<day>]...]
+//
+// Every puzzle selected, all of them by default, is run and the measures of
+// its phases (see AoC_probe.hpp) are reported in the requested format. The
+// puzzles built as standalone programs are run as child processes, with their
+// output discarded.
+//
+// The puzzles are run as a batch (see AoC_batch.hpp) on '--jobs' slots, each
+// pinned to as many CPUs as the puzzles run threads, and by default as many
+// slots as fit on the CPUs available, the longest puzzles by the times of the
+// previous runs first. With '--budget', the puzzles not
+// started after the given seconds are skipped and the ones still running are
+// killed. The time of every puzzle and the makespan of the batch are reported
+// after the phases in the 'text' format, and to the standard error otherwise.
+//
+// The answers of the puzzles, i.e. their output, are cached (see AoC_cache.hpp)
+// in 'results' in the cache directory: a puzzle whose program and input are
+// unchanged is not run again, and its phases are not reported. '--no-cache'
+// neither reads nor writes the cache, nor records the times of the puzzles;
+// '--verify' runs every puzzle and fails the ones whose answers differ from
+// those cached. '--answers' reports the answers after the times of the
+// puzzles.
+//
+// With '--scaling', every puzzle selected is run instead on synthetic inputs
+// (see AoC_gen.hpp) drawn from the seed, 0 by default, and doubling in scale
+// until a run takes the given seconds, 1 by default. The growth of the time of
+// its phases is fitted and reported (see AoC_scaling.hpp), flagging the
+// puzzles growing faster than their declared bound.
+//
+// With '--threads', the puzzles solve their parts on that many threads (see
+// AoC_pool.hpp), and else on the single CPU of their slot; '--threads=1' runs
+// them sequentially. The hardware counters of the phases solved on several
+// threads are missing, and with allocation statistics the puzzles run on a
+// single thread whatever '--threads'.
 
+#include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "AoC_2021_01.hpp"
+#include "AoC_batch.hpp"
+#include "AoC_cache.hpp"
+#include "AoC_cpu.hpp"
+#include "AoC_gen.hpp"
+#include "AoC_input.hpp"
+#include "AoC_probe.hpp"
+#include "AoC_scaling.hpp"
 
 #include <fmt/core.h>
 
+extern char** environ;
 
-int main()
-{
-  auto depths = std::array{199, 200, 208, 210, 200, 207, 240, 269, 260, 263};
+namespace {
+
+struct Puzzle {
+  int year;
+  int day;
+  char const* program; // null if run within 'aoc'
+};
+
+// Generated by CMake from the puzzle programs.
+constexpr Puzzle programs[] = {
+#include "AoC_puzzles.inc"
+};
+
+std::string label(Puzzle const& puzzle) {
+  return fmt::format("{}/{}", puzzle.year, puzzle.day);
+}
+
+// Return whether 'puzzle' is selected by 'filters', of the form "<year>" or
+// "<year>/<day>"; no filter selects all puzzles.
+bool selected(Puzzle const& puzzle, std::vector<std::string_view> const& filters) {
+  if (filters.empty()) {
+    return true;                                                      // RETURN
+  }
+  auto const name = label(puzzle);
+  for (auto const filter : filters) {
+    if (filter == name || filter == std::to_string(puzzle.year)) {
+      return true;                                                    // RETURN
+    }
+  }
+  return false;
+}
+
+// Run the 2021 example within 'aoc'.
+void run_example() {
+  auto probe = aoc::Probe{"parse"};
+  auto const depths = std::array{199, 200, 208, 210, 200, 207, 240, 269, 260, 263};
+  probe.next("part 1");
+  auto const increments = aoc::count_increases(depths);
+  probe.stop();
+  static_cast<void>(increments);
+}
+
+// Return the content of the file 'path', empty if it cannot be read.
+std::string read_file(std::filesystem::path const& path) {
+  std::string res;
+  if (auto const file = std::fopen(path.c_str(), "rb")) {
+    char buffer[4096];
+    for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) != 0; ) {
+      res.append(buffer, n);
+    }
+    std::fclose(file);
+  }
+  return res;
+}
+
+// Child processes running, killed when the budget of the batch runs out.
+class Children {
+  std::mutex mutex_;
+  std::vector<pid_t> pids_;
+  bool killed_ = false;
+
+public:
+  // Register the child 'pid', killed at once if the others were.
+  void add(pid_t const pid) {
+    auto const lock = std::lock_guard{mutex_};
+    pids_.push_back(pid);
+    if (killed_) {
+      kill(pid, SIGKILL);
+    }
+  }
+
+  // Unregister the child 'pid', before it is reaped so that its pid is not
+  // reused while registered.
+  void remove(pid_t const pid) {
+    auto const lock = std::lock_guard{mutex_};
+    pids_.erase(std::find(pids_.begin(), pids_.end(), pid));
+  }
+
+  // Kill the children registered, and the ones registered from now on.
+  void kill_all() {
+    auto const lock = std::lock_guard{mutex_};
+    killed_ = true;
+    for (auto const pid : pids_) {
+      kill(pid, SIGKILL);
+    }
+  }
+};
+
+Children children;
 
-  fmt::print("This is but an example application.\n"
-             "Out of {} depth measurements, there are {} increments.\n",
-    depths.size(), aoc::count_increases(depths));
+// Run the program of 'puzzle', with 'isa' as its instruction set if not
+// empty, on the input file 'input' if not null, and return the phases it
+// measured; print an error and return nothing if it fails. Its output is
+// stored into 'answers' if not null, and else discarded.
+std::vector<aoc::ProbeRecord> run_program(Puzzle const& puzzle, std::string_view const isa,
+                                          char const* const input = nullptr,
+                                          std::string* const answers = nullptr) {
+  auto const report = std::filesystem::temp_directory_path()
+    / fmt::format("aoc-probe-{}-{}-{}.csv", getpid(), puzzle.year, puzzle.day);
+  auto const output = answers
+    ? std::filesystem::temp_directory_path() / fmt::format("aoc-answers-{}-{}-{}.txt", getpid(), puzzle.year, puzzle.day)
+    : std::filesystem::path{"/dev/null"};
 
+  std::vector<std::string> env;
+  for (auto e = environ; *e; ++e) {
+    auto const var = std::string_view{*e};
+    if (var.substr(0, 9) != "AOC_PROBE" && (isa.empty() || var.substr(0, 8) != "AOC_ISA=")) {
+      env.emplace_back(var);
+    }
+  }
+  env.emplace_back("AOC_PROBE=csv");
+  env.push_back("AOC_PROBE_OUTPUT=" + report.string());
+  if (!isa.empty()) {
+    env.push_back(fmt::format("AOC_ISA={}", isa));
+  }
+  std::vector<char*> envp;
+  for (auto& e : env) {
+    envp.push_back(e.data());
+  }
+  envp.push_back(nullptr);
+
+  posix_spawn_file_actions_t actions;
+  posix_spawn_file_actions_init(&actions);
+  posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+  auto program = std::string{puzzle.program};
+  auto path = std::string{input ? input : ""};
+  char* argv[] = {program.data(), input ? path.data() : nullptr, nullptr};
+  pid_t pid = 0;
+  auto const error = posix_spawn(&pid, puzzle.program, &actions, nullptr, argv, envp.data());
+  posix_spawn_file_actions_destroy(&actions);
+  if (error != 0) {
+    fmt::print(stderr, "aoc: cannot run {}: {}\n", puzzle.program, std::strerror(error));
+    return {};                                                        // RETURN
+  }
+  children.add(pid);
+  siginfo_t info{};
+  waitid(P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOWAIT);
+  children.remove(pid);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  if (answers) {
+    *answers = read_file(output);
+    std::filesystem::remove(output);
+  }
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    fmt::print(stderr, "aoc: puzzle {} failed\n", label(puzzle));
+    std::filesystem::remove(report);
+    return {};                                                        // RETURN
+  }
+
+  auto const text = read_file(report);
+  std::filesystem::remove(report);
+  auto res = aoc::read_probes(text);
+  for (auto& r : res) {
+    r.puzzle = label(puzzle);
+  }
+  return res;
 }
 
+// Return the answers of 'puzzle' from 'cache' if not null and found there,
+// or else run it as by 'run_program', storing its phases into 'records', and
+// store its answers into 'cache'. With 'verify', the puzzle is run even if
+// found, and fails if its answers differ from the ones found.
+aoc::JobStatus run_cached(Puzzle const& puzzle, std::string_view const isa, aoc::ResultCache const* const cache,
+                          bool const verify, std::vector<aoc::ProbeRecord>& records, std::string& answers) {
+  std::uint64_t key = 0;
+  std::optional<std::string> found;
+  if (cache) {
+    key = aoc::result_key(read_file(puzzle.program), {}); // the input is built in
+    found = cache->find(key);
+    if (found && !verify) {
+      answers = std::move(*found);
+      return aoc::JobStatus::cached;                                  // RETURN
+    }
+  }
+  records = run_program(puzzle, isa, nullptr, &answers);
+  if (records.empty()) {
+    return aoc::JobStatus::failed;                                    // RETURN
+  }
+  if (found && *found != answers) {
+    fmt::print(stderr, "aoc: puzzle {} answers differently than cached in {:016x}\n", label(puzzle), key);
+    return aoc::JobStatus::failed;                                    // RETURN
+  }
+  if (cache && !found) {
+    cache->store(key, answers);
+  }
+  return aoc::JobStatus::done;
+}
+
+// Return the seconds the 2021 solver, run within 'aoc', takes on the input
+// file 'input'.
+double time_2021_01(std::filesystem::path const& input) {
+  auto const text = read_file(input);
+  auto const start = std::chrono::steady_clock::now();
+  auto const depths = aoc::numbers(text);
+  auto const increments = aoc::count_increases(depths);
+  auto const stop = std::chrono::steady_clock::now();
+  static_cast<void>(increments);
+  return std::chrono::duration<double>(stop - start).count();
+}
+
+// Return the scaling of 'puzzle' on the inputs of 'generator', drawn from
+// 'seed' and doubling in scale from the smallest one until a run takes
+// 'budget' seconds or the largest scale is reached. Every scale is run three
+// times, keeping the fastest, and the time is that of all the phases; the
+// samples stop at the first run failing.
+aoc::ScalingReport run_scaling(Puzzle const& puzzle, aoc::Generator const& generator,
+                               std::string_view const isa, std::uint64_t const seed, double const budget) {
+  auto res = aoc::ScalingReport{label(puzzle), generator.unit, generator.bound, {}, {}};
+  auto const input = std::filesystem::temp_directory_path()
+    / fmt::format("aoc-scaling-{}-{}-{}.txt", getpid(), puzzle.year, puzzle.day);
+  for (auto scale = generator.min_scale;; scale = std::min(std::max(2 * scale, scale + 1), generator.max_scale)) {
+    if (auto const file = std::fopen(input.c_str(), "wb")) {
+      aoc::generate(file, generator, scale, seed);
+      std::fclose(file);
+    }
+    auto seconds = 0.0;
+    for (auto i = 0; i < 3; ++i) {
+      auto time = 0.0;
+      if (puzzle.program) {
+        auto const run = run_program(puzzle, isa, input.c_str());
+        if (run.empty()) {
+          std::filesystem::remove(input);
+          res.fit = aoc::fit_complexity(res.samples);
+          return res;                                                 // RETURN
+        }
+        for (auto const& r : run) {
+          time += r.measure.seconds;
+        }
+      }
+      else {
+        time = time_2021_01(input);
+      }
+      seconds = i == 0 ? time : std::min(seconds, time);
+    }
+    res.samples.push_back({scale, seconds});
+    if (seconds >= budget || scale == generator.max_scale) {
+      break;
+    }
+  }
+  std::filesystem::remove(input);
+  res.fit = aoc::fit_complexity(res.samples);
+  return res;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  auto format = aoc::ProbeFormat::text;
+  std::string_view isa;
+  std::optional<double> budget; // seconds, set by '--scaling'
+  std::uint64_t seed = 0;
+  auto const cpus = aoc::affinity_cpus();
+  std::size_t jobs = 0; // as many as fit on 'cpus' by default
+  std::optional<double> deadline; // seconds, set by '--budget'
+  bool use_cache = true;
+  bool verify = false;
+  bool show_answers = false;
+  std::vector<std::string_view> filters;
+  for (int i = 1; i < argc; ++i) {
+    auto const arg = std::string_view{argv[i]};
+    if (arg.substr(0, 6) == "--isa=") {
+      // '--isa=<name>' caps the instruction set of the kernels, for benchmarks.
+      isa = arg.substr(6);
+      auto const cap = aoc::parse_isa(isa);
+      if (!cap) {
+        fmt::print(stderr, "Unknown instruction set '{}'\n", isa);
+        return 1;                                                     // RETURN
+      }
+      aoc::force_isa(*cap);
+    }
+    else if (arg.substr(0, 9) == "--format=") {
+      auto const f = aoc::parse_probe_format(arg.substr(9));
+      if (!f) {
+        fmt::print(stderr, "Unknown format '{}'\n", arg.substr(9));
+        return 1;                                                     // RETURN
+      }
+      format = *f;
+    }
+    else if (arg == "--scaling" || arg.substr(0, 10) == "--scaling=") {
+      auto const b = arg.size() > 10 ? std::strtod(argv[i] + 10, nullptr) : 1.0;
+      if (!(b > 0)) {
+        fmt::print(stderr, "Invalid budget '{}'\n", arg.substr(10));
+        return 1;                                                     // RETURN
+      }
+      budget = b;
+    }
+    else if (arg.substr(0, 7) == "--jobs=") {
+      auto const n = std::strtol(argv[i] + 7, nullptr, 10);
+      if (!(n > 0)) {
+        fmt::print(stderr, "Invalid job count '{}'\n", arg.substr(7));
+        return 1;                                                     // RETURN
+      }
+      jobs = static_cast<std::size_t>(n);
+    }
+    else if (arg.substr(0, 9) == "--budget=") {
+      auto const b = std::strtod(argv[i] + 9, nullptr);
+      if (!(b > 0)) {
+        fmt::print(stderr, "Invalid budget '{}'\n", arg.substr(9));
+        return 1;                                                     // RETURN
+      }
+      deadline = b;
+    }
+    else if (arg == "--no-cache") {
+      use_cache = false;
+    }
+    else if (arg == "--verify") {
+      verify = true;
+    }
+    else if (arg == "--answers") {
+      show_answers = true;
+    }
+    else if (arg.substr(0, 10) == "--threads=") {
+      // Passed on to the puzzles run as child processes through the environment,
+      // and read back below to size the slots.
+      if (!(std::strtol(argv[i] + 10, nullptr, 10) > 0)) {
+        fmt::print(stderr, "Invalid thread count '{}'\n", arg.substr(10));
+        return 1;                                                     // RETURN
+      }
+      setenv("AOC_THREADS", argv[i] + 10, 1);
+    }
+    else if (arg.substr(0, 7) == "--seed=") {
+      seed = std::strtoull(argv[i] + 7, nullptr, 10);
+    }
+    else {
+      filters.push_back(arg);
+    }
+  }
+
+  // Every slot gets a CPU per thread of the puzzles, so that they do not
+  // compete for the CPUs of the others.
+  auto const width = std::getenv("AOC_THREADS")
+    ? std::clamp<std::size_t>(aoc::thread_count(), 1, std::max<std::size_t>(cpus.size(), 1)) : 1;
+  if (jobs == 0) {
+    jobs = std::max<std::size_t>(cpus.size() / width, 1);
+  }
+
+  if (budget) {
+    std::vector<aoc::ScalingReport> reports;
+    auto all = std::vector<Puzzle>(std::begin(programs), std::end(programs));
+    all.push_back({2021, 1, nullptr});
+    for (auto const& puzzle : all) {
+      auto const generator = aoc::find_generator(puzzle.year, puzzle.day);
+      if (!selected(puzzle, filters) || !generator) {
+        continue;
+      }
+      reports.push_back(run_scaling(puzzle, *generator, isa, seed, *budget));
+    }
+    aoc::write_scaling(stdout, format, reports);
+    return 0;                                                         // RETURN
+  }
+
+  auto const timings_path = aoc::batch_timings_path();
+  auto const timings = aoc::read_timings(read_file(timings_path));
+  auto const estimate = [&](Puzzle const& puzzle) -> std::optional<double> {
+    auto const t = timings.find(label(puzzle));
+    return t != timings.end() ? std::optional{t->second} : std::nullopt;
+  };
+  auto const cache = aoc::ResultCache{aoc::cache_directory() / "results"};
+  std::vector<aoc::BatchJob> batch;
+  std::vector<std::vector<aoc::ProbeRecord>> runs; // by job
+  std::vector<std::string> answers;                // by job
+  auto const selection = std::count_if(std::begin(programs), std::end(programs), [&](auto const& p) {
+    return selected(p, filters);
+  });
+  runs.resize(static_cast<std::size_t>(selection) + 1);
+  answers.resize(runs.size());
+  for (auto const& puzzle : programs) {
+    if (!selected(puzzle, filters)) {
+      continue;
+    }
+    auto const i = batch.size();
+    batch.push_back({label(puzzle), estimate(puzzle), [&, i] {
+      return run_cached(puzzle, isa, use_cache ? &cache : nullptr, verify, runs[i], answers[i]);
+    }});
+  }
+  auto const example = Puzzle{2021, 1, nullptr};
+  if (selected(example, filters)) {
+    batch.push_back({label(example), estimate(example), [] {
+      run_example();
+      return aoc::JobStatus::done;
+    }});
+  }
+  auto const report = aoc::run_batch(batch, jobs, cpus, width, deadline, [] { children.kill_all(); });
+
+  std::vector<aoc::ProbeRecord> records;
+  bool failed = false;
+  for (std::size_t i = 0; i < batch.size(); ++i) {
+    auto const status = report.runs[i].status;
+    failed = failed || (status != aoc::JobStatus::done && status != aoc::JobStatus::cached);
+    records.insert(records.end(), runs[i].begin(), runs[i].end());
+  }
+  for (auto r : aoc::probe_records()) { // of the example
+    r.puzzle = label(example);
+    records.push_back(std::move(r));
+  }
+
+  if (use_cache) {
+    std::error_code error;
+    std::filesystem::create_directories(timings_path.parent_path(), error);
+    if (auto const file = std::fopen(timings_path.c_str(), "wb")) {
+      aoc::write_timings(file, aoc::update_timings(timings, report));
+      std::fclose(file);
+    }
+  }
+
+  if (format == aoc::ProbeFormat::text) {
+    fmt::print("Kernels run with {}.\n", aoc::isa_name(aoc::active_isa()));
+    std::fflush(stdout);
+  }
+  aoc::write_probes(stdout, format, records);
+  std::fflush(stdout);
+  auto const summary = format == aoc::ProbeFormat::text ? stdout : stderr;
+  std::fputc('\n', summary);
+  aoc::write_batch(summary, aoc::ProbeFormat::text, report);
+  if (show_answers) {
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+      if (!answers[i].empty()) {
+        fmt::print(summary, "\n{}:\n{}", batch[i].name, answers[i]);
+      }
+    }
+  }
+  return failed ? 1 : 0;
+}
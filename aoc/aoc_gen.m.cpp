@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+// File aoc_gen.m.cpp
+///////////////////////////////////////////////////////////////////////////////
+// This is an application generating synthetic Advent of Code inputs.
+//
+// Usage: aoc_gen [--seed=<n>] <year>/<day> <scale>
+//        aoc_gen --list
+//
+// The input of the puzzle, at the given scale, is written to the standard
+// output; the same seed, 0 by default, always gives the same input. The puzzle
+// programs read it when given its file as their first argument:
+//
+//   aoc_gen --seed=7 2020/8 100000 > boot.txt && aoc2020_day8 boot.txt
+//
+// '--list' prints the puzzles supported, with what their scale counts.
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string_view>
+#include <system_error>
+
+#include "AoC_gen.hpp"
+
+#include <fmt/core.h>
+
+namespace {
+
+// Return the number 'text' holds entirely, or nothing.
+template <typename Int>
+std::optional<Int> to_number(std::string_view const text) {
+  Int res{};
+  auto const [end, error] = std::from_chars(text.data(), text.data() + text.size(), res);
+  if (error != std::errc{} || end != text.data() + text.size()) {
+    return {};                                                        // RETURN
+  }
+  return res;
+}
+
+void list() {
+  for (auto const& g : aoc::generators()) {
+    fmt::print("{}/{}: {} ({} to {})\n", g.year, g.day, g.unit, g.min_scale, g.max_scale);
+  }
+}
+
+int usage() {
+  fmt::print(stderr, "Usage: aoc_gen [--seed=<n>] <year>/<day> <scale>\n"
+                     "       aoc_gen --list\n");
+  return 2;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  std::uint64_t seed = 0;
+  std::string_view puzzle;
+  std::string_view scale;
+  for (int i = 1; i < argc; ++i) {
+    auto const arg = std::string_view{argv[i]};
+    if (arg == "--list") {
+      list();
+      return 0;                                                       // RETURN
+    }
+    else if (arg.substr(0, 7) == "--seed=") {
+      auto const s = to_number<std::uint64_t>(arg.substr(7));
+      if (!s) {
+        fmt::print(stderr, "Invalid seed '{}'\n", arg.substr(7));
+        return 1;                                                     // RETURN
+      }
+      seed = *s;
+    }
+    else if (puzzle.empty()) {
+      puzzle = arg;
+    }
+    else if (scale.empty()) {
+      scale = arg;
+    }
+    else {
+      return usage();                                                 // RETURN
+    }
+  }
+  if (puzzle.empty() || scale.empty()) {
+    return usage();                                                   // RETURN
+  }
+
+  auto const slash = puzzle.find('/');
+  auto const year = to_number<int>(puzzle.substr(0, slash));
+  auto const day = slash == puzzle.npos ? std::nullopt : to_number<int>(puzzle.substr(slash + 1));
+  auto const generator = year && day ? aoc::find_generator(*year, *day) : nullptr;
+  if (!generator) {
+    fmt::print(stderr, "No generator for puzzle '{}' (see --list)\n", puzzle);
+    return 1;                                                         // RETURN
+  }
+  auto const n = to_number<std::uint64_t>(scale);
+  if (!n) {
+    fmt::print(stderr, "Invalid scale '{}'\n", scale);
+    return 1;                                                         // RETURN
+  }
+  if (*n < generator->min_scale || *n > generator->max_scale) {
+    fmt::print(stderr, "Scale of {} clamped to [{}, {}] {}\n",
+      puzzle, generator->min_scale, generator->max_scale, generator->unit);
+  }
+  aoc::generate(stdout, *generator, *n, seed);
+  return std::fflush(stdout) == 0 ? 0 : 1;
+}
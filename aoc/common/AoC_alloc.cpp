@@ -0,0 +1,180 @@
+#include "AoC_alloc.hpp"
+
+#ifdef AOC_ALLOC_STATS
+
+#include <algorithm> // max
+#include <atomic>    // atomic
+#include <cstddef>   // max_align_t, size_t
+#include <cstdio>    // fprintf
+#include <cstdlib>   // aligned_alloc, exit, free, malloc
+#include <cstring>   // memcpy
+#include <new>       // align_val_t, bad_alloc, get_new_handler, nothrow_t
+
+namespace {
+
+std::atomic<std::uint64_t> allocations{0};
+std::atomic<std::uint64_t> bytes{0};
+std::atomic<std::uint64_t> live{0};
+std::atomic<std::uint64_t> peak{0};
+thread_local std::uint64_t thread_allocations = 0; // for 'NoAllocation'
+
+auto constexpr min_align = alignof(std::max_align_t);
+
+// Every block starts with a header of 'max(align, min_align)' bytes, which
+// ends with the size requested, so that 'operator delete' knows what it frees
+// even when it is not told.
+void* allocate(std::size_t const size, std::size_t const align) noexcept {
+  auto const header = std::max(align, min_align);
+  auto const total = size + header;
+  void* const base = align <= min_align
+    ? std::malloc(total)
+    : std::aligned_alloc(align, (total + align - 1) / align * align);
+  if (!base) {
+    return nullptr;                                                   // RETURN
+  }
+  auto const res = static_cast<char*>(base) + header;
+  std::memcpy(res - sizeof(size), &size, sizeof(size));
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  ++thread_allocations;
+  bytes.fetch_add(size, std::memory_order_relaxed);
+  auto const now = live.fetch_add(size, std::memory_order_relaxed) + size;
+  auto high = peak.load(std::memory_order_relaxed);
+  while (now > high && !peak.compare_exchange_weak(high, now, std::memory_order_relaxed)) {
+  }
+  return res;
+}
+
+void release(void* const p, std::size_t const align) noexcept {
+  if (!p) {
+    return;                                                           // RETURN
+  }
+  auto const block = static_cast<char*>(p);
+  std::size_t size = 0;
+  std::memcpy(&size, block - sizeof(size), sizeof(size));
+  live.fetch_sub(size, std::memory_order_relaxed);
+  std::free(block - std::max(align, min_align));
+}
+
+// 'allocate', or throw as 'operator new' must.
+void* allocate_or_throw(std::size_t const size, std::size_t const align) {
+  for (;;) {
+    if (auto const res = allocate(size, align)) {
+      return res;                                                     // RETURN
+    }
+    auto const handler = std::get_new_handler();
+    if (!handler) {
+      throw std::bad_alloc{};
+    }
+    handler();
+  }
+}
+
+} // namespace
+
+aoc::AllocStats aoc::alloc_stats() noexcept {
+  return {allocations.load(std::memory_order_relaxed), bytes.load(std::memory_order_relaxed),
+          live.load(std::memory_order_relaxed), peak.load(std::memory_order_relaxed)};
+}
+
+void aoc::reset_alloc_peak() noexcept {
+  peak.store(live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+aoc::NoAllocation::NoAllocation(char const* const name) noexcept
+  : name_{name}, start_{thread_allocations} {
+}
+
+aoc::NoAllocation::~NoAllocation() {
+  auto const n = thread_allocations - start_;
+  if (n != 0) {
+    std::fprintf(stderr, "%s: %llu allocations in a path declared not to allocate\n", name_,
+                 static_cast<unsigned long long>(n));
+    std::exit(EXIT_FAILURE);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Replacement allocation functions
+///////////////////////////////////////////////////////////////////////////////
+
+void* operator new(std::size_t const size) {
+  return allocate_or_throw(size, min_align);
+}
+
+void* operator new[](std::size_t const size) {
+  return allocate_or_throw(size, min_align);
+}
+
+void* operator new(std::size_t const size, std::align_val_t const align) {
+  return allocate_or_throw(size, static_cast<std::size_t>(align));
+}
+
+void* operator new[](std::size_t const size, std::align_val_t const align) {
+  return allocate_or_throw(size, static_cast<std::size_t>(align));
+}
+
+void* operator new(std::size_t const size, std::nothrow_t const&) noexcept {
+  return allocate(size, min_align);
+}
+
+void* operator new[](std::size_t const size, std::nothrow_t const&) noexcept {
+  return allocate(size, min_align);
+}
+
+void* operator new(std::size_t const size, std::align_val_t const align, std::nothrow_t const&) noexcept {
+  return allocate(size, static_cast<std::size_t>(align));
+}
+
+void* operator new[](std::size_t const size, std::align_val_t const align, std::nothrow_t const&) noexcept {
+  return allocate(size, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* const p) noexcept {
+  release(p, min_align);
+}
+
+void operator delete[](void* const p) noexcept {
+  release(p, min_align);
+}
+
+void operator delete(void* const p, std::size_t) noexcept {
+  release(p, min_align);
+}
+
+void operator delete[](void* const p, std::size_t) noexcept {
+  release(p, min_align);
+}
+
+void operator delete(void* const p, std::align_val_t const align) noexcept {
+  release(p, static_cast<std::size_t>(align));
+}
+
+void operator delete[](void* const p, std::align_val_t const align) noexcept {
+  release(p, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* const p, std::size_t, std::align_val_t const align) noexcept {
+  release(p, static_cast<std::size_t>(align));
+}
+
+void operator delete[](void* const p, std::size_t, std::align_val_t const align) noexcept {
+  release(p, static_cast<std::size_t>(align));
+}
+
+void operator delete(void* const p, std::nothrow_t const&) noexcept {
+  release(p, min_align);
+}
+
+void operator delete[](void* const p, std::nothrow_t const&) noexcept {
+  release(p, min_align);
+}
+
+void operator delete(void* const p, std::align_val_t const align, std::nothrow_t const&) noexcept {
+  release(p, static_cast<std::size_t>(align));
+}
+
+void operator delete[](void* const p, std::align_val_t const align, std::nothrow_t const&) noexcept {
+  release(p, static_cast<std::size_t>(align));
+}
+
+#endif // AOC_ALLOC_STATS
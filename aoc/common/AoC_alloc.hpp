@@ -0,0 +1,77 @@
+#ifndef AOC_ALLOC_HEADER_GUARD
+#define AOC_ALLOC_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_alloc.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Heap allocation statistics. When built with 'AOC_ALLOC_STATS' (the CMake
+// option 'ENABLE_ALLOC_STATS'), the global 'operator new' and 'operator
+// delete' are replaced by ones counting the allocations, the bytes allocated
+// and the bytes live, which the probes report for every phase (see
+// AoC_probe.hpp). Without it, nothing is counted and the scopes below are
+// free.
+#include <cstdint> // uint64_t
+
+namespace aoc {
+
+// Whether the allocations are counted.
+#ifdef AOC_ALLOC_STATS
+inline auto constexpr alloc_stats_enabled = true;
+#else
+inline auto constexpr alloc_stats_enabled = false;
+#endif
+
+// Counts of the program since its start, all threads included.
+struct AllocStats {
+  std::uint64_t allocations = 0; // calls to 'operator new'
+  std::uint64_t bytes = 0;       // bytes requested by those calls
+  std::uint64_t live = 0;        // bytes allocated and not yet freed
+  std::uint64_t peak = 0;        // highest 'live' since the last 'reset_alloc_peak'
+};
+
+// Return the current counts; all zero if not 'alloc_stats_enabled'.
+AllocStats alloc_stats() noexcept;
+
+// Restart the tracking of the peak from the bytes currently live.
+void reset_alloc_peak() noexcept;
+
+// Scope declaring a hot path which must not allocate, named 'name'. If it
+// does, with the allocations counted, the program prints the count to the
+// standard error and exits with failure when the scope ends, so that a
+// benchmark run through it fails. Only the allocations of the thread of the
+// scope are counted, which are all those of its work as the thread pool then
+// runs everything on the caller (see AoC_pool.hpp).
+class NoAllocation {
+#ifdef AOC_ALLOC_STATS
+  char const* name_;
+  std::uint64_t start_;
+#endif
+
+public:
+  explicit NoAllocation(char const* name) noexcept;
+  NoAllocation(NoAllocation const&) = delete;
+  NoAllocation& operator=(NoAllocation const&) = delete;
+  ~NoAllocation();
+};
+
+} // namespace aoc
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef AOC_ALLOC_STATS
+inline aoc::AllocStats aoc::alloc_stats() noexcept {
+  return {};
+}
+
+inline void aoc::reset_alloc_peak() noexcept {
+}
+
+inline aoc::NoAllocation::NoAllocation(char const*) noexcept {
+}
+
+inline aoc::NoAllocation::~NoAllocation() {
+}
+#endif
+
+#endif // AOC_ALLOC_HEADER_GUARD
@@ -0,0 +1,93 @@
+#include "AoC_arena.hpp"
+
+#include <algorithm> // max
+#include <cstdint>   // uintptr_t
+#include <new>       // bad_alloc, operator new
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+std::size_t page_size() noexcept {
+  static auto const res = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  return res;
+}
+
+void* map(std::size_t const size) {
+  auto const res = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (res == MAP_FAILED) {
+    throw std::bad_alloc{};
+  }
+  return res;
+}
+
+void unmap(void* const p, std::size_t const size) noexcept {
+  munmap(p, size);
+}
+#else
+std::size_t page_size() noexcept {
+  return 4096;
+}
+
+void* map(std::size_t const size) {
+  return ::operator new(size);
+}
+
+void unmap(void* const p, std::size_t) noexcept {
+  ::operator delete(p);
+}
+#endif
+
+// Return the bytes to skip from 'p' to the next multiple of 'alignment', a
+// power of two.
+std::size_t padding(char const* const p, std::size_t const alignment) noexcept {
+  return -reinterpret_cast<std::uintptr_t>(p) & (alignment - 1);
+}
+
+} // namespace
+
+aoc::Arena::Arena(std::size_t const block_size) noexcept
+  : block_size_{std::max(block_size, sizeof(Block))}, next_size_{block_size_} {
+}
+
+aoc::Arena::~Arena() {
+  release();
+}
+
+void aoc::Arena::release() noexcept {
+  while (blocks_) {
+    auto const next = blocks_->next;
+    unmap(blocks_, blocks_->size);
+    blocks_ = next;
+  }
+  cursor_ = end_ = nullptr;
+  next_size_ = block_size_;
+}
+
+void* aoc::Arena::do_allocate(std::size_t const bytes, std::size_t const alignment) {
+  if (!cursor_ || padding(cursor_, alignment) + bytes > static_cast<std::size_t>(end_ - cursor_)) {
+    auto const page = page_size();
+    auto const needed = sizeof(Block) + alignment + bytes;
+    auto const size = (std::max(next_size_, needed) + page - 1) / page * page;
+    auto const block = static_cast<Block*>(map(size));
+    *block = {blocks_, size};
+    blocks_ = block;
+    next_size_ = 2 * size;
+    cursor_ = reinterpret_cast<char*>(block + 1);
+    end_ = reinterpret_cast<char*>(block) + size;
+  }
+  auto const res = cursor_ + padding(cursor_, alignment);
+  cursor_ = res + bytes;
+  return res;
+}
+
+void aoc::Arena::do_deallocate(void*, std::size_t, std::size_t) noexcept {
+}
+
+bool aoc::Arena::do_is_equal(std::pmr::memory_resource const& other) const noexcept {
+  return this == &other;
+}
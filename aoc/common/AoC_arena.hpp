@@ -0,0 +1,56 @@
+#ifndef AOC_ARENA_HEADER_GUARD
+#define AOC_ARENA_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_arena.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Monotonic memory resource for the data a solver parses: memory is carved
+// out of large blocks mapped with 'mmap' by bumping a pointer, and is given
+// back all at once, when the arena is released or destroyed. Deallocation is a
+// no-op, so that the 'std::pmr' containers bound to an arena neither call
+// 'malloc' while they are built nor 'free' when they are destroyed.
+//
+//   auto arena = aoc::Arena{};
+//   auto const rules = parse_rules(input, &arena);
+//
+// The containers must be destroyed before the arena they are bound to. An
+// arena is not thread-safe.
+#include <cstddef>         // size_t
+#include <memory_resource> // memory_resource
+
+namespace aoc {
+
+class Arena : public std::pmr::memory_resource {
+  struct Block {
+    Block* next;
+    std::size_t size; // bytes mapped, this header included
+  };
+
+  Block* blocks_ = nullptr; // most recent first
+  char* cursor_ = nullptr;
+  char* end_ = nullptr;
+  std::size_t block_size_;
+  std::size_t next_size_;
+
+  void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+  void do_deallocate(void* p, std::size_t bytes, std::size_t alignment) noexcept override;
+  bool do_is_equal(std::pmr::memory_resource const& other) const noexcept override;
+
+public:
+  static auto constexpr default_block_size = std::size_t{1} << 20;
+
+  // Create an arena mapping its first block, of at least 'block_size' bytes,
+  // on the first allocation; every following block is twice as large as the
+  // previous one.
+  explicit Arena(std::size_t block_size = default_block_size) noexcept;
+  Arena(Arena const&) = delete;
+  Arena& operator=(Arena const&) = delete;
+  ~Arena() override;
+
+  // Unmap all the blocks, invalidating the memory allocated so far; the next
+  // block mapped is of 'block_size' bytes again.
+  void release() noexcept;
+};
+
+} // namespace aoc
+
+#endif // AOC_ARENA_HEADER_GUARD
@@ -0,0 +1,219 @@
+#include "AoC_batch.hpp"
+#include "AoC_parse.hpp"
+
+#include <algorithm> // max, stable_sort
+#include <atomic>    // atomic
+#include <chrono>    // steady_clock, duration, milliseconds
+#include <cstdlib>   // getenv
+#include <limits>    // numeric_limits
+#include <numeric>   // iota
+#include <thread>    // thread, sleep_for
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point const start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string_view status_name(aoc::JobStatus const status) noexcept {
+  switch (status) {
+  case aoc::JobStatus::done: return "done";                           // RETURN
+  case aoc::JobStatus::cached: return "cached";                       // RETURN
+  case aoc::JobStatus::failed: return "failed";                       // RETURN
+  case aoc::JobStatus::killed: return "killed";                       // RETURN
+  case aoc::JobStatus::skipped: return "skipped";                     // RETURN
+  }
+  return "?";
+}
+
+} // namespace
+
+std::filesystem::path aoc::cache_directory() {
+  if (auto const dir = std::getenv("AOC_CACHE_DIR"); dir && *dir) {
+    return dir;                                                       // RETURN
+  }
+  if (auto const dir = std::getenv("XDG_CACHE_HOME"); dir && *dir) {
+    return std::filesystem::path{dir} / "aoc";                        // RETURN
+  }
+  if (auto const home = std::getenv("HOME"); home && *home) {
+    return std::filesystem::path{home} / ".cache" / "aoc";            // RETURN
+  }
+  return std::filesystem::temp_directory_path() / "aoc";
+}
+
+std::filesystem::path aoc::batch_timings_path() {
+  return cache_directory() / "timings.csv";
+}
+
+std::map<std::string, double> aoc::read_timings(std::string_view const text) {
+  std::map<std::string, double> res;
+  for (auto const line : Lines{text}) {
+    auto const comma = line.rfind(',');
+    if (comma == std::string_view::npos || comma + 1 == line.size() || !is_digit(line[comma + 1])) {
+      continue; // garbage
+    }
+    res[std::string{line.substr(0, comma)}] = std::stod(std::string{line.substr(comma + 1)});
+  }
+  return res;
+}
+
+void aoc::write_timings(std::FILE* const out, std::map<std::string, double> const& timings) {
+  for (auto const& [name, seconds] : timings) {
+    std::fprintf(out, "%s,%.9f\n", name.c_str(), seconds);
+  }
+}
+
+double aoc::BatchReport::total() const noexcept {
+  double res = 0;
+  for (auto const& r : runs) {
+    res += r.seconds;
+  }
+  return res;
+}
+
+aoc::BatchReport aoc::run_batch(std::span<BatchJob const> const jobs, std::size_t const slots,
+                                std::span<int const> const cpus, std::size_t const width,
+                                std::optional<double> const budget,
+                                std::function<void()> const& cancel) {
+  auto const pin = 0 < width && width < cpus.size();
+  auto res = BatchReport{std::vector<BatchRun>(jobs.size()), std::max<std::size_t>(slots, 1),
+                         pin ? width : 0, 0};
+  std::vector<std::size_t> order(jobs.size());
+  std::iota(begin(order), end(order), std::size_t{0});
+  auto const estimate = [&](std::size_t const i) {
+    return jobs[i].estimate.value_or(std::numeric_limits<double>::infinity());
+  };
+  std::stable_sort(begin(order), end(order), [&](auto const lhs, auto const rhs) {
+    return estimate(lhs) > estimate(rhs);
+  });
+
+  std::atomic<std::size_t> next{0};
+  std::atomic<std::size_t> finished{0};
+  std::atomic<bool> expired{false};
+  auto const start = Clock::now();
+  auto const work = [&](std::size_t const slot) {
+    std::vector<int> own;
+    for (std::size_t k = 0; pin && k < width; ++k) {
+      own.push_back(cpus[(slot * width + k) % cpus.size()]);
+    }
+    auto const cpu = pin_thread(own) ? own.front() : -1;
+    for (std::size_t k; (k = next.fetch_add(1)) < order.size(); finished.fetch_add(1)) {
+      auto const i = order[k];
+      auto& run = res.runs[i];
+      run.name = jobs[i].name;
+      if (expired.load()) {
+        continue; // skipped
+      }
+      run.cpu = cpu;
+      run.start = seconds_since(start);
+      auto const status = jobs[i].run();
+      run.seconds = seconds_since(start) - run.start;
+      run.status = status == JobStatus::failed && expired.load() ? JobStatus::killed : status;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t s = 1; s < res.slots; ++s) {
+    threads.emplace_back(work, s);
+  }
+  std::thread watchdog;
+  if (budget) { // polled every 10 ms at most
+    watchdog = std::thread{[&] {
+      auto const deadline = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(*budget));
+      while (finished.load() < jobs.size()) {
+        auto const now = Clock::now();
+        if (now >= deadline) {
+          expired.store(true);
+          if (cancel) {
+            cancel();
+          }
+          return;                                                     // RETURN
+        }
+        std::this_thread::sleep_for(std::min<Clock::duration>(deadline - now, std::chrono::milliseconds{10}));
+      }
+    }};
+  }
+  work(0);
+  for (auto& t : threads) {
+    t.join();
+  }
+  res.makespan = seconds_since(start);
+  if (watchdog.joinable()) {
+    watchdog.join();
+  }
+  return res;
+}
+
+std::map<std::string, double> aoc::update_timings(std::map<std::string, double> timings,
+                                                  BatchReport const& report) {
+  for (auto const& r : report.runs) {
+    if (r.status != JobStatus::done) {
+      continue;
+    }
+    auto const [it, inserted] = timings.try_emplace(r.name, r.seconds);
+    if (!inserted) {
+      it->second = (it->second + r.seconds) / 2;
+    }
+  }
+  return timings;
+}
+
+void aoc::write_batch(std::FILE* const out, ProbeFormat const format, BatchReport const& report) {
+  switch (format) {
+  case ProbeFormat::text:
+    std::fprintf(out, "%-8s %-8s %4s %12s %12s\n", "puzzle", "status", "cpu", "start [ms]", "time [ms]");
+    for (auto const& r : report.runs) {
+      std::fprintf(out, "%-8s %-8s", r.name.c_str(), status_name(r.status).data());
+      if (r.cpu >= 0) {
+        std::fprintf(out, " %4d", r.cpu);
+      }
+      else {
+        std::fprintf(out, " %4s", "-");
+      }
+      if (r.status == JobStatus::skipped) {
+        std::fprintf(out, " %12s %12s\n", "-", "-");
+      }
+      else {
+        std::fprintf(out, " %12.3f %12.3f\n", r.start * 1e3, r.seconds * 1e3);
+      }
+    }
+    std::fprintf(out, "makespan %.3f ms on %zu slots", report.makespan * 1e3, report.slots);
+    if (report.width > 0) {
+      std::fprintf(out, " of %zu CPUs", report.width);
+    }
+    std::fprintf(out, ", sum of times %.3f ms (%.2fx)\n", report.total() * 1e3,
+                 report.makespan > 0 ? report.total() / report.makespan : 0.0);
+    break;
+  case ProbeFormat::json:
+    std::fprintf(out, "{\"slots\": %zu, \"width\": %zu, \"makespan\": %.9f, \"total\": %.9f, \"jobs\": [",
+                 report.slots, report.width, report.makespan, report.total());
+    for (std::size_t i = 0; i < report.runs.size(); ++i) {
+      auto const& r = report.runs[i];
+      std::fputs(i == 0 ? "\n  {\"puzzle\": " : ",\n  {\"puzzle\": ", out);
+      detail::put_json(out, r.name);
+      std::fputs(", \"status\": ", out);
+      detail::put_json(out, status_name(r.status));
+      if (r.cpu >= 0) {
+        std::fprintf(out, ", \"cpu\": %d", r.cpu);
+      }
+      else {
+        std::fputs(", \"cpu\": null", out);
+      }
+      std::fprintf(out, ", \"start\": %.9f, \"seconds\": %.9f}", r.start, r.seconds);
+    }
+    std::fputs("\n]}\n", out);
+    break;
+  case ProbeFormat::csv:
+    std::fputs("puzzle,status,cpu,start,seconds\n", out);
+    for (auto const& r : report.runs) {
+      std::fprintf(out, "%s,%s,", r.name.c_str(), status_name(r.status).data());
+      if (r.cpu >= 0) {
+        std::fprintf(out, "%d", r.cpu);
+      }
+      std::fprintf(out, ",%.9f,%.9f\n", r.start, r.seconds);
+    }
+    break;
+  }
+}
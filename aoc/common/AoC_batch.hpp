@@ -0,0 +1,92 @@
+#ifndef AOC_BATCH_HEADER_GUARD
+#define AOC_BATCH_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_batch.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Batch of jobs run concurrently on a fixed number of slots, the longest first
+// by estimate (the "LPT" rule), so that the batch ends about when its longest
+// job does. Every slot is a thread pinned to its own CPUs, as many as the
+// threads a job runs on (see 'pin_thread'): the jobs it runs, and the
+// processes they spawn, stay on these CPUs and keep their caches to
+// themselves.
+//
+// The estimates come from the times of the previous batches, kept by name in
+// the file 'batch_timings_path()'; a job never timed is run first.
+#include <cstdio>      // FILE
+#include <filesystem>  // path
+#include <functional>  // function
+#include <map>         // map
+#include <optional>    // optional
+#include <span>        // span
+#include <string>      // string
+#include <string_view> // string_view
+#include <vector>      // vector
+
+#include "AoC_pool.hpp"
+#include "AoC_probe.hpp"
+
+namespace aoc {
+
+// Return the directory keeping the state of the runner between runs:
+// 'AOC_CACHE_DIR' if set, and else 'aoc' in '$XDG_CACHE_HOME' or in
+// '$HOME/.cache'.
+std::filesystem::path cache_directory();
+
+// Return the file keeping the times of the previous batches.
+std::filesystem::path batch_timings_path();
+
+// Return the seconds by job name read from 'text', one 'name,seconds' line per
+// job. The lines which cannot be read are skipped.
+std::map<std::string, double> read_timings(std::string_view text);
+
+// Write 'timings' to 'out', in the format read by 'read_timings'.
+void write_timings(std::FILE* out, std::map<std::string, double> const& timings);
+
+enum class JobStatus { done, cached, failed, killed, skipped };
+
+struct BatchJob {
+  std::string name;
+  std::optional<double> estimate; // seconds, missing if never timed
+  std::function<JobStatus()> run; // return 'done', 'cached' or 'failed'
+};
+
+struct BatchRun {
+  std::string name;
+  JobStatus status = JobStatus::skipped;
+  int cpu = -1;        // first CPU of the slot, which is not pinned if negative
+  double start = 0;    // seconds since the batch started
+  double seconds = 0;
+};
+
+struct BatchReport {
+  std::vector<BatchRun> runs; // in the order of the jobs
+  std::size_t slots = 0;
+  std::size_t width = 0;      // CPUs per slot, 0 if not pinned
+  double makespan = 0;        // seconds from the start of the batch to its end
+
+  // Return the sum of the times of the jobs run.
+  double total() const noexcept;
+};
+
+// Run 'jobs' on 'slots' threads, the longest estimate first. Each thread is
+// pinned to the next 'width' CPUs of 'cpus', wrapping around, unless they are
+// all of them. With a 'budget' in seconds, the jobs not started once it has
+// run out are skipped, and 'cancel' is called so that the ones running stop
+// early: those which then fail are reported as killed.
+BatchReport run_batch(std::span<BatchJob const> jobs, std::size_t slots, std::span<int const> cpus,
+                      std::size_t width, std::optional<double> budget = std::nullopt,
+                      std::function<void()> const& cancel = {});
+
+// Return 'timings' updated with the times of the jobs of 'report' done,
+// the time of every job being the mean of its last time and its previous
+// estimate, so that a single slow run is half forgotten by the next.
+std::map<std::string, double> update_timings(std::map<std::string, double> timings,
+                                             BatchReport const& report);
+
+// Write 'report' to 'out' in 'format': a line per job, and in the 'text'
+// format a last line comparing the makespan with the sum of the times.
+void write_batch(std::FILE* out, ProbeFormat format, BatchReport const& report);
+
+} // namespace aoc
+
+#endif // AOC_BATCH_HEADER_GUARD
@@ -0,0 +1,59 @@
+#include "AoC_cache.hpp"
+#include "AoC_hash.hpp"
+
+#include <cstdio>       // FILE, fopen, fread, fwrite, fclose, snprintf
+#include <system_error> // error_code
+#include <thread>       // this_thread, hash
+#include <utility>      // move
+
+#include <unistd.h>
+
+std::uint64_t aoc::result_key(std::string_view const program, std::string_view const input) noexcept {
+  return hash_bytes(input, hash_bytes(program));
+}
+
+aoc::ResultCache::ResultCache(std::filesystem::path directory)
+  : directory_{std::move(directory)} {
+}
+
+std::filesystem::path aoc::ResultCache::entry(std::uint64_t const key) const {
+  char name[24];
+  std::snprintf(name, sizeof(name), "%016llx.txt", static_cast<unsigned long long>(key));
+  return directory_ / name;
+}
+
+std::optional<std::string> aoc::ResultCache::find(std::uint64_t const key) const {
+  auto const file = std::fopen(entry(key).c_str(), "rb");
+  if (!file) {
+    return std::nullopt;                                              // RETURN
+  }
+  std::string res;
+  char buffer[4096];
+  for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) != 0; ) {
+    res.append(buffer, n);
+  }
+  std::fclose(file);
+  return res;
+}
+
+bool aoc::ResultCache::store(std::uint64_t const key, std::string_view const answers) const {
+  std::error_code error;
+  std::filesystem::create_directories(directory_, error);
+  auto const path = entry(key);
+  char suffix[48];
+  std::snprintf(suffix, sizeof(suffix), ".%ld.%zu", static_cast<long>(getpid()),
+                std::hash<std::thread::id>{}(std::this_thread::get_id()));
+  auto temporary = path;
+  temporary += suffix;
+  auto const file = std::fopen(temporary.c_str(), "wb");
+  if (!file) {
+    return false;                                                     // RETURN
+  }
+  auto const written = std::fwrite(answers.data(), 1, answers.size(), file) == answers.size();
+  if (std::fclose(file) != 0 || !written) {
+    std::filesystem::remove(temporary, error);
+    return false;                                                     // RETURN
+  }
+  std::filesystem::rename(temporary, path, error);
+  return !error;
+}
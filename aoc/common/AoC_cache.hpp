@@ -0,0 +1,41 @@
+#ifndef AOC_CACHE_HEADER_GUARD
+#define AOC_CACHE_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_cache.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Persistent cache of the answers of the puzzles, addressed by content: the
+// key of a run is the hash (see AoC_hash.hpp) of the solver, i.e. the bytes
+// of its program, and of its input, so that rebuilding a solver or changing
+// an input makes a new key, and an entry never needs to be invalidated. Every
+// entry is a file named after its key, written whole under a temporary name
+// then renamed, so that concurrent runs never read half an entry.
+#include <cstdint>     // uint64_t
+#include <filesystem>  // path
+#include <optional>    // optional
+#include <string>      // string
+#include <string_view> // string_view
+
+namespace aoc {
+
+// Return the key of the run of the solver 'program' on 'input'.
+std::uint64_t result_key(std::string_view program, std::string_view input) noexcept;
+
+class ResultCache {
+  std::filesystem::path directory_;
+
+  std::filesystem::path entry(std::uint64_t key) const;
+
+public:
+  // Create a cache kept in 'directory', created on first store.
+  explicit ResultCache(std::filesystem::path directory);
+
+  // Return the answers stored under 'key', if any.
+  std::optional<std::string> find(std::uint64_t key) const;
+
+  // Store 'answers' under 'key', and return whether they could be.
+  bool store(std::uint64_t key, std::string_view answers) const;
+};
+
+} // namespace aoc
+
+#endif // AOC_CACHE_HEADER_GUARD
@@ -0,0 +1,73 @@
+#include "AoC_cpu.hpp"
+
+#include <algorithm> // min
+#include <cstdio>    // fprintf
+#include <cstdlib>   // getenv
+
+namespace {
+
+constexpr std::array<std::string_view, aoc::isa_count> names = {
+  "generic", "sse4.2", "avx2", "avx512"
+};
+
+// Cap set by 'force_isa', and whether it is too late to set one.
+std::atomic<aoc::Isa> forced{aoc::Isa::avx512};
+std::atomic<bool> frozen{false};
+
+} // namespace
+
+std::string_view aoc::isa_name(Isa const isa) noexcept {
+  return names[static_cast<std::size_t>(isa)];
+}
+
+std::optional<aoc::Isa> aoc::parse_isa(std::string_view const name) noexcept {
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    if (names[i] == name) {
+      return static_cast<Isa>(i);                                     // RETURN
+    }
+  }
+  return std::nullopt;
+}
+
+aoc::Isa aoc::detect_isa() noexcept {
+#ifdef AOC_HAS_TARGETS
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")
+      && __builtin_cpu_supports("avx512vl")) {
+    return Isa::avx512;                                               // RETURN
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2")
+      && __builtin_cpu_supports("fma")) {
+    return Isa::avx2;                                                 // RETURN
+  }
+  if (__builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt")) {
+    return Isa::sse42;                                                // RETURN
+  }
+#endif
+  return Isa::generic;
+}
+
+aoc::Isa aoc::active_isa() noexcept {
+  static auto const res = [] {
+    frozen = true;
+    auto isa = std::min(detect_isa(), forced.load());
+    if (auto const env = std::getenv("AOC_ISA")) {
+      if (auto const cap = parse_isa(env)) {
+        isa = std::min(isa, *cap);
+      }
+      else {
+        std::fprintf(stderr, "AOC_ISA: unknown instruction set '%s', ignored\n", env);
+      }
+    }
+    return isa;
+  }();
+  return res;
+}
+
+bool aoc::force_isa(Isa const isa) noexcept {
+  if (frozen) {
+    return false;                                                     // RETURN
+  }
+  forced = std::min(forced.load(), isa);
+  return true;
+}
@@ -0,0 +1,96 @@
+#ifndef AOC_CPU_HEADER_GUARD
+#define AOC_CPU_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_cpu.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Runtime dispatch of the hot kernels: every kernel is compiled for several
+// instruction sets, and the variant run is chosen once, on the first call,
+// from what the processor supports ('cpuid'). The choice can be capped with
+// the environment variable 'AOC_ISA' or with 'force_isa', e.g. to compare the
+// variants on the same machine.
+#include <array>       // array
+#include <atomic>      // atomic
+#include <optional>    // optional
+#include <string_view> // string_view
+
+// 'AOC_TARGET(isa)' compiles a function for 'isa', whatever the flags of the
+// translation unit; 'AOC_HAS_TARGETS' tells whether it is supported.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define AOC_HAS_TARGETS 1
+#define AOC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define AOC_TARGET(isa)
+#endif
+
+namespace aoc {
+
+// Instruction sets, each one implying the ones before it.
+//   sse42:  SSE4.2 and POPCNT
+//   avx2:   AVX2, BMI2 and FMA
+//   avx512: AVX-512 F, BW and VL
+enum class Isa : unsigned char { generic, sse42, avx2, avx512 };
+
+inline auto constexpr isa_count = std::size_t{4};
+
+// Return the name of 'isa', as accepted by 'parse_isa'.
+std::string_view isa_name(Isa isa) noexcept;
+
+// Return the instruction set named 'name', if any.
+std::optional<Isa> parse_isa(std::string_view name) noexcept;
+
+// Return the best instruction set supported by the processor.
+Isa detect_isa() noexcept;
+
+// Return the instruction set the kernels are run with: the one detected,
+// capped by 'AOC_ISA' or by 'force_isa'. Once returned, it never changes.
+Isa active_isa() noexcept;
+
+// Cap the instruction set of the kernels to 'isa'. Return 'false', doing
+// nothing, if the choice was already made, i.e. if a kernel already ran.
+bool force_isa(Isa isa) noexcept;
+
+// Kernel of type 'Fn', a pointer to function, with one variant per
+// instruction set; a null variant falls back to the one before it, and the
+// generic one is mandatory. Meant to be a constant-initialized global.
+template <typename Fn>
+class Kernel {
+  std::array<Fn, isa_count> variants_;
+  mutable std::atomic<Fn> resolved_{nullptr};
+
+  Fn resolve() const noexcept;
+
+public:
+  constexpr Kernel(Fn generic, Fn sse42, Fn avx2, Fn avx512) noexcept
+    : variants_{generic, sse42, avx2, avx512} {
+  }
+
+  // Return the variant to run, choosing it on the first call.
+  Fn get() const noexcept {
+    auto const res = resolved_.load(std::memory_order_relaxed);
+    return res ? res : resolve();
+  }
+
+  template <typename... Args>
+  decltype(auto) operator()(Args&&... args) const {
+    return get()(static_cast<Args&&>(args)...);
+  }
+};
+
+} // namespace aoc
+
+///////////////////////////////////////////////////////////////////////////////
+// Template definitions
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename Fn>
+Fn aoc::Kernel<Fn>::resolve() const noexcept {
+  auto i = static_cast<std::size_t>(active_isa());
+  while (!variants_[i]) {
+    --i;
+  }
+  // Concurrent first calls all store the same value.
+  resolved_.store(variants_[i], std::memory_order_relaxed);
+  return variants_[i];
+}
+
+#endif // AOC_CPU_HEADER_GUARD
@@ -0,0 +1,144 @@
+#include "AoC_grid.hpp"
+#include "AoC_cpu.hpp"
+
+#include <algorithm> // max
+#include <bit>       // popcount
+
+namespace {
+
+// Return the number of bits set in 'words[i]', or in 'words[i] & masks[i]',
+// for 'i' in '[0, n)'.
+using CountOnes = std::size_t(*)(std::uint64_t const* words, std::size_t n) noexcept;
+using CountMasked = std::size_t(*)(std::uint64_t const* words, std::uint64_t const* masks,
+                                   std::size_t n) noexcept;
+
+std::size_t count_ones_generic(std::uint64_t const* const words, std::size_t const n) noexcept {
+  std::size_t res = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    res += static_cast<std::size_t>(std::popcount(words[i]));
+  }
+  return res;
+}
+
+std::size_t count_masked_generic(std::uint64_t const* const words, std::uint64_t const* const masks,
+                                 std::size_t const n) noexcept {
+  std::size_t res = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    res += static_cast<std::size_t>(std::popcount(words[i] & masks[i]));
+  }
+  return res;
+}
+
+#ifdef AOC_HAS_TARGETS
+// The same loops, where 'popcount' is one instruction instead of a call.
+AOC_TARGET("popcnt")
+std::size_t count_ones_sse42(std::uint64_t const* const words, std::size_t const n) noexcept {
+  std::size_t res = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    res += static_cast<std::size_t>(std::popcount(words[i]));
+  }
+  return res;
+}
+
+AOC_TARGET("popcnt")
+std::size_t count_masked_sse42(std::uint64_t const* const words, std::uint64_t const* const masks,
+                               std::size_t const n) noexcept {
+  std::size_t res = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    res += static_cast<std::size_t>(std::popcount(words[i] & masks[i]));
+  }
+  return res;
+}
+#else
+auto constexpr count_ones_sse42 = CountOnes{nullptr};
+auto constexpr count_masked_sse42 = CountMasked{nullptr};
+#endif
+
+constinit aoc::Kernel<CountOnes> const count_ones{
+  count_ones_generic, count_ones_sse42, nullptr, nullptr
+};
+constinit aoc::Kernel<CountMasked> const count_masked{
+  count_masked_generic, count_masked_sse42, nullptr, nullptr
+};
+
+} // namespace
+
+std::size_t aoc::popcount(std::span<std::uint64_t const> const words) noexcept {
+  return count_ones(words.data(), words.size());
+}
+
+aoc::Grid<bool>::Grid(std::size_t const rows, std::size_t const cols, bool const value,
+                      std::size_t const halo)
+  : rows_{rows}, cols_{cols}, halo_{halo}, fill_{value} {
+  auto const words = (cols + 2*halo + 63) / 64;
+  stride_ = (words + 7) / 8 * 8; // whole cache lines
+  data_.assign((rows + 2*halo) * stride_, value ? ~std::uint64_t{0} : 0);
+}
+
+std::size_t aoc::Grid<bool>::word(std::ptrdiff_t const row, std::ptrdiff_t const col) const noexcept {
+  auto const h = static_cast<std::ptrdiff_t>(halo_);
+  assert( -h <= row && row < static_cast<std::ptrdiff_t>(rows_) + h );
+  assert( -h <= col && col < static_cast<std::ptrdiff_t>(cols_) + h );
+  return static_cast<std::size_t>(row + h) * stride_ + static_cast<std::size_t>(col + h) / 64;
+}
+
+std::uint64_t aoc::Grid<bool>::bit(std::ptrdiff_t const col) const noexcept {
+  return std::uint64_t{1} << (static_cast<std::size_t>(col) + halo_) % 64;
+}
+
+std::uint64_t aoc::Grid<bool>::interior(std::size_t const w) const noexcept {
+  auto const first = w * 64;
+  auto const lo = std::max(first, halo_);
+  auto const hi = std::min(first + 64, halo_ + cols_);
+  if (lo >= hi) {
+    return 0;                                                         // RETURN
+  }
+  auto const n = hi - lo;
+  auto const ones = n == 64 ? ~std::uint64_t{0} : (std::uint64_t{1} << n) - 1;
+  return ones << (lo - first);
+}
+
+void aoc::Grid<bool>::reserve(std::size_t const rows) {
+  data_.reserve((rows + 2*halo_) * stride_);
+}
+
+void aoc::Grid<bool>::add_row(bool const value) {
+  // The first row of the bottom halo becomes the new row.
+  data_.resize(data_.size() + stride_, fill_ ? ~std::uint64_t{0} : 0);
+  auto const words = row(static_cast<std::ptrdiff_t>(rows_++));
+  for (std::size_t w = 0; w < stride_; ++w) {
+    auto const mask = interior(w);
+    words[w] = value ? words[w] | mask : words[w] & ~mask;
+  }
+}
+
+bool aoc::Grid<bool>::at(std::ptrdiff_t const row, std::ptrdiff_t const col) const noexcept {
+  return (data_[word(row, col)] & bit(col)) != 0;
+}
+
+void aoc::Grid<bool>::set(std::ptrdiff_t const row, std::ptrdiff_t const col,
+                          bool const value) noexcept {
+  auto& w = data_[word(row, col)];
+  w = value ? w | bit(col) : w & ~bit(col);
+}
+
+std::span<std::uint64_t const> aoc::Grid<bool>::row(std::ptrdiff_t const row) const noexcept {
+  return {data_.data() + word(row, -static_cast<std::ptrdiff_t>(halo_)), stride_};
+}
+
+std::span<std::uint64_t> aoc::Grid<bool>::row(std::ptrdiff_t const row) noexcept {
+  return {data_.data() + word(row, -static_cast<std::ptrdiff_t>(halo_)), stride_};
+}
+
+std::size_t aoc::Grid<bool>::count(bool const value) const noexcept {
+  auto masks = std::vector<std::uint64_t>(stride_);
+  for (std::size_t w = 0; w < stride_; ++w) {
+    masks[w] = interior(w);
+  }
+  auto const kernel = count_masked.get();
+  std::size_t ones = 0;
+  for (std::size_t r = 0; r < rows_; ++r) { // accumulate
+    ones += kernel(row(static_cast<std::ptrdiff_t>(r)).data(), masks.data(), stride_);
+  }
+  return value ? ones : rows_ * cols_ - ones;
+}
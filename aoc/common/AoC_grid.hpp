@@ -0,0 +1,245 @@
+#ifndef AOC_GRID_HEADER_GUARD
+#define AOC_GRID_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_grid.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Two-dimensional grids of cells, stored row by row. Every row is padded to a
+// whole number of cache lines, and the grid may be surrounded by a halo: a
+// border of 'halo' cells on every side, addressed with negative coordinates
+// or coordinates past the last row or column, so that stencils can read the
+// neighbors of any cell without checking bounds.
+#include <cstddef> // size_t, ptrdiff_t
+#include <cstdint> // uint64_t
+#include <new>     // align_val_t
+#include <span>    // span
+#include <vector>  // vector
+
+namespace aoc {
+
+// Minimal allocator returning storage aligned to 'Align' bytes.
+template <typename T, std::size_t Align = 64>
+struct AlignedAllocator {
+  using value_type = T;
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Align>;
+  };
+
+  AlignedAllocator() noexcept = default;
+  template <typename U>
+  AlignedAllocator(AlignedAllocator<U, Align> const&) noexcept {}
+
+  T* allocate(std::size_t n);
+  void deallocate(T* p, std::size_t n) noexcept;
+
+  friend bool operator==(AlignedAllocator, AlignedAllocator) noexcept { return true; }
+  friend bool operator!=(AlignedAllocator, AlignedAllocator) noexcept { return false; }
+};
+
+// Return the number of bits set in 'words'.
+std::size_t popcount(std::span<std::uint64_t const> words) noexcept;
+
+// Grid of 'rows() x cols()' values of type 'T', plus a halo of 'halo()'
+// cells on every side. New rows are added at the bottom, in amortized
+// constant time, and without any reallocation within the reserved capacity.
+template <typename T>
+class Grid {
+  static auto constexpr line = std::size_t{64};
+
+  std::vector<T, AlignedAllocator<T, line>> data_;
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::size_t halo_ = 0;
+  std::size_t stride_ = 0; // distance between rows, halo and padding included
+  T fill_{};               // value of the halo and of the new cells
+
+  std::size_t index(std::ptrdiff_t row, std::ptrdiff_t col) const noexcept;
+
+public:
+  Grid() = default;
+
+  // Create a grid of 'rows x cols' cells, all of them, as well as the ones of
+  // the halo, set to 'value'.
+  Grid(std::size_t rows, std::size_t cols, T const& value = T{}, std::size_t halo = 0);
+
+  std::size_t rows() const noexcept { return rows_; }
+  std::size_t cols() const noexcept { return cols_; }
+  std::size_t halo() const noexcept { return halo_; }
+  std::size_t stride() const noexcept { return stride_; }
+
+  // Make room for 'rows' rows in total.
+  void reserve(std::size_t rows);
+
+  // Add a row at the bottom, with all its cells set to 'value', or copied
+  // from '[first, last)' which must be 'cols()' long.
+  void add_row(T const& value);
+  template <typename It>
+  void add_row(It first, It last);
+
+  // Return the cell at 'row' and 'col', which may lie in the halo.
+  T const& at(std::ptrdiff_t row, std::ptrdiff_t col) const noexcept;
+  T& at(std::ptrdiff_t row, std::ptrdiff_t col) noexcept;
+  void set(std::ptrdiff_t row, std::ptrdiff_t col, T value) noexcept;
+
+  // Return the 'cols()' cells of 'row', which may lie in the halo.
+  std::span<T const> row(std::ptrdiff_t row) const noexcept;
+  std::span<T> row(std::ptrdiff_t row) noexcept;
+
+  // Return the number of cells equal to 'value', the halo excluded.
+  std::size_t count(T const& value) const noexcept;
+};
+
+// Bit-packed grid of booleans, with the same interface but for the rows,
+// which are spans of 64-bit words. Column 'c' is bit '(c + halo()) % 64' of
+// the word '(c + halo()) / 64' of its row.
+template <>
+class Grid<bool> {
+  std::vector<std::uint64_t, AlignedAllocator<std::uint64_t, 64>> data_;
+  std::size_t rows_ = 0;
+  std::size_t cols_ = 0;
+  std::size_t halo_ = 0;
+  std::size_t stride_ = 0; // in words
+  bool fill_ = false;
+
+  std::size_t word(std::ptrdiff_t row, std::ptrdiff_t col) const noexcept;
+  std::uint64_t bit(std::ptrdiff_t col) const noexcept;
+
+  // Return the mask of the bits of the 'w'-th word of a row which stand for
+  // columns in '[0, cols())'.
+  std::uint64_t interior(std::size_t w) const noexcept;
+
+public:
+  Grid() = default;
+  Grid(std::size_t rows, std::size_t cols, bool value = false, std::size_t halo = 0);
+
+  std::size_t rows() const noexcept { return rows_; }
+  std::size_t cols() const noexcept { return cols_; }
+  std::size_t halo() const noexcept { return halo_; }
+  std::size_t stride() const noexcept { return stride_; }
+
+  void reserve(std::size_t rows);
+
+  void add_row(bool value);
+  template <typename It>
+  void add_row(It first, It last);
+
+  bool at(std::ptrdiff_t row, std::ptrdiff_t col) const noexcept;
+  void set(std::ptrdiff_t row, std::ptrdiff_t col, bool value) noexcept;
+
+  // Return the words of 'row', halo and padding included.
+  std::span<std::uint64_t const> row(std::ptrdiff_t row) const noexcept;
+  std::span<std::uint64_t> row(std::ptrdiff_t row) noexcept;
+
+  std::size_t count(bool value) const noexcept;
+};
+
+} // namespace aoc
+
+///////////////////////////////////////////////////////////////////////////////
+// Template definitions
+///////////////////////////////////////////////////////////////////////////////
+#include <algorithm> // copy, count, fill_n
+#include <cassert>   // assert
+#include <iterator>  // distance
+#include <utility>   // move
+
+template <typename T, std::size_t Align>
+T* aoc::AlignedAllocator<T, Align>::allocate(std::size_t const n) {
+  return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Align}));
+}
+
+template <typename T, std::size_t Align>
+void aoc::AlignedAllocator<T, Align>::deallocate(T* const p, std::size_t) noexcept {
+  ::operator delete(p, std::align_val_t{Align});
+}
+
+template <typename T>
+aoc::Grid<T>::Grid(std::size_t const rows, std::size_t const cols, T const& value,
+                   std::size_t const halo)
+  : rows_{rows}, cols_{cols}, halo_{halo}, fill_{value} {
+  auto const width = cols + 2*halo;
+  stride_ = line % sizeof(T) == 0
+    ? (width * sizeof(T) + line - 1) / line * (line / sizeof(T))
+    : width;
+  data_.assign((rows + 2*halo) * stride_, value);
+}
+
+template <typename T>
+std::size_t aoc::Grid<T>::index(std::ptrdiff_t const row, std::ptrdiff_t const col) const noexcept {
+  auto const h = static_cast<std::ptrdiff_t>(halo_);
+  assert( -h <= row && row < static_cast<std::ptrdiff_t>(rows_) + h );
+  assert( -h <= col && col < static_cast<std::ptrdiff_t>(cols_) + h );
+  return static_cast<std::size_t>(row + h) * stride_ + static_cast<std::size_t>(col + h);
+}
+
+template <typename T>
+void aoc::Grid<T>::reserve(std::size_t const rows) {
+  data_.reserve((rows + 2*halo_) * stride_);
+}
+
+template <typename T>
+void aoc::Grid<T>::add_row(T const& value) {
+  // The first row of the bottom halo becomes the new row.
+  data_.resize(data_.size() + stride_, fill_);
+  auto const first = index(static_cast<std::ptrdiff_t>(rows_++), 0);
+  std::fill_n(data_.begin() + static_cast<std::ptrdiff_t>(first), cols_, value);
+}
+
+template <typename T>
+template <typename It>
+void aoc::Grid<T>::add_row(It const first, It const last) {
+  assert( static_cast<std::size_t>(std::distance(first, last)) == cols_ );
+  data_.resize(data_.size() + stride_, fill_);
+  auto const pos = index(static_cast<std::ptrdiff_t>(rows_++), 0);
+  std::copy(first, last, data_.begin() + static_cast<std::ptrdiff_t>(pos));
+}
+
+template <typename T>
+T const& aoc::Grid<T>::at(std::ptrdiff_t const row, std::ptrdiff_t const col) const noexcept {
+  return data_[index(row, col)];
+}
+
+template <typename T>
+T& aoc::Grid<T>::at(std::ptrdiff_t const row, std::ptrdiff_t const col) noexcept {
+  return data_[index(row, col)];
+}
+
+template <typename T>
+void aoc::Grid<T>::set(std::ptrdiff_t const row, std::ptrdiff_t const col, T value) noexcept {
+  data_[index(row, col)] = std::move(value);
+}
+
+template <typename T>
+std::span<T const> aoc::Grid<T>::row(std::ptrdiff_t const row) const noexcept {
+  return {data_.data() + index(row, 0), cols_};
+}
+
+template <typename T>
+std::span<T> aoc::Grid<T>::row(std::ptrdiff_t const row) noexcept {
+  return {data_.data() + index(row, 0), cols_};
+}
+
+template <typename T>
+std::size_t aoc::Grid<T>::count(T const& value) const noexcept {
+  std::size_t res = 0;
+  for (std::size_t r = 0; r < rows_; ++r) { // accumulate
+    auto const cells = row(static_cast<std::ptrdiff_t>(r));
+    res += static_cast<std::size_t>(std::count(cells.begin(), cells.end(), value));
+  }
+  return res;
+}
+
+template <typename It>
+void aoc::Grid<bool>::add_row(It first, It const last) {
+  assert( static_cast<std::size_t>(std::distance(first, last)) == cols_ );
+  add_row(false);
+  auto const r = static_cast<std::ptrdiff_t>(rows_ - 1);
+  for (std::ptrdiff_t c = 0; first != last; ++first, ++c) {
+    if (*first) {
+      set(r, c, true);
+    }
+  }
+}
+
+#endif // AOC_GRID_HEADER_GUARD
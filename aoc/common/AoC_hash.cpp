@@ -0,0 +1,79 @@
+#include "AoC_hash.hpp"
+
+#include <bit>     // rotl
+#include <cstring> // memcpy
+
+namespace {
+
+auto constexpr prime1 = std::uint64_t{11400714785074694791u};
+auto constexpr prime2 = std::uint64_t{14029467366897019727u};
+auto constexpr prime3 = std::uint64_t{1609587929392839161u};
+auto constexpr prime4 = std::uint64_t{9650029242287828579u};
+auto constexpr prime5 = std::uint64_t{2870177450012600261u};
+
+// Return the little-endian integer of type 'T' at 'p'.
+template <typename T>
+T load(char const* const p) noexcept {
+  T res;
+  std::memcpy(&res, p, sizeof(res));
+  if constexpr (std::endian::native == std::endian::big) {
+    T swapped = 0;
+    for (std::size_t i = 0; i < sizeof(T); ++i) {
+      swapped = static_cast<T>(swapped << 8 | ((res >> (8 * i)) & 0xff));
+    }
+    res = swapped;
+  }
+  return res;
+}
+
+std::uint64_t mix(std::uint64_t acc, std::uint64_t const input) noexcept {
+  acc += input * prime2;
+  return std::rotl(acc, 31) * prime1;
+}
+
+std::uint64_t merge(std::uint64_t const acc, std::uint64_t const lane) noexcept {
+  return (acc ^ mix(0, lane)) * prime1 + prime4;
+}
+
+} // namespace
+
+std::uint64_t aoc::hash_bytes(std::string_view const bytes, std::uint64_t const seed) noexcept {
+  auto p = bytes.data();
+  auto const end = p + bytes.size();
+  std::uint64_t res;
+  if (bytes.size() >= 32) {
+    std::uint64_t lanes[4] = {seed + prime1 + prime2, seed + prime2, seed, seed - prime1};
+    for (; end - p >= 32; p += 32) {
+      for (std::size_t i = 0; i < 4; ++i) {
+        lanes[i] = mix(lanes[i], load<std::uint64_t>(p + 8 * i));
+      }
+    }
+    res = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+    for (auto const lane : lanes) {
+      res = merge(res, lane);
+    }
+  }
+  else {
+    res = seed + prime5;
+  }
+  res += bytes.size();
+  for (; end - p >= 8; p += 8) {
+    res ^= mix(0, load<std::uint64_t>(p));
+    res = std::rotl(res, 27) * prime1 + prime4;
+  }
+  if (end - p >= 4) {
+    res ^= load<std::uint32_t>(p) * prime1;
+    res = std::rotl(res, 23) * prime2 + prime3;
+    p += 4;
+  }
+  for (; p != end; ++p) {
+    res ^= static_cast<unsigned char>(*p) * prime5;
+    res = std::rotl(res, 11) * prime1;
+  }
+  res ^= res >> 33;
+  res *= prime2;
+  res ^= res >> 29;
+  res *= prime3;
+  res ^= res >> 32;
+  return res;
+}
@@ -0,0 +1,21 @@
+#ifndef AOC_HASH_HEADER_GUARD
+#define AOC_HASH_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_hash.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Fast non-cryptographic hash of bytes, XXH64: it goes through the bytes by
+// stripes of 32 bytes, on 4 independent lanes, at several bytes per cycle.
+// It tells contents apart, but offers no protection against collisions made
+// on purpose.
+#include <cstdint>     // uint64_t
+#include <string_view> // string_view
+
+namespace aoc {
+
+// Return the XXH64 hash of 'bytes', with 'seed' as seed; hashing several
+// contents in a row, e.g. 'hash_bytes(b, hash_bytes(a))', hashes them all.
+std::uint64_t hash_bytes(std::string_view bytes, std::uint64_t seed = 0) noexcept;
+
+} // namespace aoc
+
+#endif // AOC_HASH_HEADER_GUARD
@@ -0,0 +1,33 @@
+#include "AoC_input.hpp"
+
+#include <cerrno>  // errno
+#include <cstdio>  // FILE, fopen, fread
+#include <cstdlib> // exit
+#include <cstring> // strerror
+#include <string>  // string
+
+std::string_view aoc::input(int const argc, char* argv[], std::string_view const embedded) {
+  if (argc < 2) {
+    return embedded;                                                  // RETURN
+  }
+  static std::string res;
+  auto const path = std::string_view{argv[1]};
+  auto const file = path == "-" ? stdin : std::fopen(argv[1], "rb");
+  if (!file) {
+    std::fprintf(stderr, "%s: cannot read %s: %s\n", argv[0], argv[1], std::strerror(errno));
+    std::exit(EXIT_FAILURE);
+  }
+  char buffer[1 << 16];
+  for (std::size_t n; (n = std::fread(buffer, 1, sizeof(buffer), file)) != 0; ) {
+    res.append(buffer, n);
+  }
+  auto const failed = std::ferror(file);
+  if (file != stdin) {
+    std::fclose(file);
+  }
+  if (failed) {
+    std::fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[1]);
+    std::exit(EXIT_FAILURE);
+  }
+  return res;
+}
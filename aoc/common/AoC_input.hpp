@@ -0,0 +1,40 @@
+#ifndef AOC_INPUT_HEADER_GUARD
+#define AOC_INPUT_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_input.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Input of the puzzle programs: the input embedded in the program, unless the
+// program is given a file as its first argument, e.g. a synthetic input
+// written by 'aoc_gen' for a scaling benchmark.
+#include <string_view> // string_view
+#include <vector>      // vector
+
+namespace aoc {
+
+// Return the content of the file named by 'argv[1]', "-" naming the standard
+// input, if 'argc > 1', and else 'embedded'. The content read is kept until
+// the program exits. Print an error and exit with failure if the file cannot
+// be read.
+std::string_view input(int argc, char* argv[], std::string_view embedded);
+
+// Return the values of the runs of decimal digits of 'text', in order.
+template <typename Int = int>
+std::vector<Int> numbers(std::string_view text);
+
+} // namespace aoc
+
+///////////////////////////////////////////////////////////////////////////////
+// Template definitions
+///////////////////////////////////////////////////////////////////////////////
+#include "AoC_parse.hpp"
+
+template <typename Int>
+std::vector<Int> aoc::numbers(std::string_view text) {
+  std::vector<Int> res;
+  for (aoc::skip_to_digit(text); !text.empty(); aoc::skip_to_digit(text)) {
+    res.push_back(aoc::fetch_int<Int>(text));
+  }
+  return res;
+}
+
+#endif // AOC_INPUT_HEADER_GUARD
@@ -0,0 +1,69 @@
+#include "AoC_parse.hpp"
+
+#if defined(AOC_HAS_TARGETS) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+std::uint64_t newline_mask_generic(char const* const block) noexcept {
+#if defined(__SSE2__)
+  auto const newline = _mm_set1_epi8('\n');
+  std::uint64_t res = 0;
+  for (int i = 0; i < 4; ++i) {
+    auto const v = _mm_loadu_si128(reinterpret_cast<__m128i const*>(block + 16*i));
+    auto const m = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, newline)));
+    res |= std::uint64_t{m} << (16*i);
+  }
+  return res;
+#else
+  // SWAR: a byte of 'x' is zero if and only if its high bit survives, and the
+  // eight high bits are then gathered into the top byte by one multiplication.
+  auto constexpr low7 = std::uint64_t{0x7f7f7f7f7f7f7f7f};
+  auto constexpr newlines = std::uint64_t{0x0a0a0a0a0a0a0a0a};
+  std::uint64_t res = 0;
+  for (int i = 0; i < 8; ++i) {
+    auto const x = aoc::load_chunk(block + 8*i) ^ newlines;
+    auto const zero = ~(((x & low7) + low7) | x | low7);
+    res |= ((zero >> 7) * std::uint64_t{0x0102040810204080} >> 56) << (8*i);
+  }
+  return res;
+#endif
+}
+
+#ifdef AOC_HAS_TARGETS
+AOC_TARGET("avx2")
+std::uint64_t newline_mask_avx2(char const* const block) noexcept {
+  auto const newline = _mm256_set1_epi8('\n');
+  auto const lo = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(block));
+  auto const hi = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(block + 32));
+  auto const mlo = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(lo, newline)));
+  auto const mhi = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(hi, newline)));
+  return std::uint64_t{mhi} << 32 | mlo;
+}
+
+AOC_TARGET("avx512f,avx512bw")
+std::uint64_t newline_mask_avx512(char const* const block) noexcept {
+  auto const v = _mm512_loadu_si512(block);
+  return _mm512_cmpeq_epi8_mask(v, _mm512_set1_epi8('\n'));
+}
+#else
+auto constexpr newline_mask_avx2 = aoc::detail::NewlineMask{nullptr};
+auto constexpr newline_mask_avx512 = aoc::detail::NewlineMask{nullptr};
+#endif
+
+} // namespace
+
+constinit aoc::Kernel<aoc::detail::NewlineMask> const aoc::detail::newline_mask_kernel{
+  newline_mask_generic, nullptr, newline_mask_avx2, newline_mask_avx512
+};
+
+std::uint64_t aoc::newline_mask(char const* const block, std::size_t const size) noexcept {
+  // The tail of a text is never more than one block, which is not worth
+  // vectorizing, and cannot be read as a whole block past the end of the text.
+  std::uint64_t res = 0;
+  for (std::size_t i = 0; i < size; ++i) {
+    res |= std::uint64_t{block[i] == '\n'} << i;
+  }
+  return res;
+}
@@ -0,0 +1,322 @@
+#ifndef AOC_PARSE_HEADER_GUARD
+#define AOC_PARSE_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_parse.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Scanning primitives shared by the puzzle parsers: lines are found through a
+// bitmap of the newlines of every 64-byte block, and runs of digits are
+// converted eight at a time within a 64-bit word. The bitmaps are computed by
+// a kernel dispatched on the instruction set (see AoC_cpu.hpp).
+#include <cstddef>     // size_t
+#include <cstdint>     // uint32_t, uint64_t
+#include <iterator>    // input_iterator_tag
+#include <string_view> // string_view
+
+#include "AoC_cpu.hpp"
+
+namespace aoc {
+
+// Return whether 'c' is a decimal digit.
+constexpr bool is_digit(char c) noexcept;
+
+namespace detail {
+using NewlineMask = std::uint64_t (*)(char const*) noexcept;
+extern Kernel<NewlineMask> const newline_mask_kernel;
+} // namespace detail
+
+// Return the bitmap of the newlines among the 64 bytes starting at 'block':
+// bit 'i' is set if and only if 'block[i]' is '\n'.
+inline std::uint64_t newline_mask(char const* block) noexcept;
+
+// Return the bitmap of the newlines among the 'size' bytes starting at
+// 'block', where 'size' must be lower than 64.
+std::uint64_t newline_mask(char const* block, std::size_t size) noexcept;
+
+// Return the 8 bytes starting at 'p' as a little-endian word, that is with
+// 'p[0]' as the lowest byte.
+inline std::uint64_t load_chunk(char const* p) noexcept;
+
+// Return whether every byte of 'chunk' is a decimal digit.
+constexpr bool is_eight_digits(std::uint64_t chunk) noexcept;
+
+// Return the value of the eight decimal digits of 'chunk', the most
+// significant one in the lowest byte. The behavior is undefined unless
+// 'is_eight_digits(chunk)'.
+constexpr std::uint32_t parse_eight_digits(std::uint64_t chunk) noexcept;
+
+// Return the value of 'digits', which must only contain decimal digits
+// preceded, if 'Int' is signed, by an optional '+' or '-'. The behavior is
+// undefined if the value does not fit in 'Int'.
+template <typename Int = int>
+Int to_int(std::string_view digits) noexcept;
+
+// Remove the leading characters of 'text' up to, but not including, its first
+// decimal digit. If there is none, 'text' becomes empty.
+inline void skip_to_digit(std::string_view& text) noexcept;
+
+// Return the value of the first run of decimal digits in 'text', and remove
+// 'text' up to the end of that run. Signs are not digits: in "1-3" the second
+// run is 3. Return 0 and empty 'text' if there is no digit.
+template <typename Int = int>
+Int fetch_int(std::string_view& text) noexcept;
+
+// Parse 'text' as a decimal integer with 'std::from_chars' semantics and
+// remove the characters consumed. Return 'false', leaving 'text' and 'value'
+// untouched, if 'text' does not start with an integer or if it overflows.
+template <typename Int>
+bool parse_int(std::string_view& text, Int& value) noexcept;
+
+// Return the first line of 'text', not including its newline, and remove it
+// from 'text' along with that newline, if any.
+inline std::string_view fetch_line(std::string_view& text) noexcept;
+
+// Range of the lines of a text, each one without its newline. A newline ends
+// the line before it, so that "a\nb" and "a\nb\n" both have two lines and an
+// empty text has none.
+class Lines {
+  std::string_view text_;
+
+public:
+  class iterator;
+  struct sentinel {};
+
+  explicit Lines(std::string_view text) noexcept;
+
+  iterator begin() const noexcept;
+  sentinel end() const noexcept;
+};
+
+// Input iterator over 'Lines', scanning one 64-byte block at a time: the
+// newline bitmap of the current block is kept so that every byte is examined
+// once, whatever the length of the lines.
+class Lines::iterator {
+  char const* first_;     // first character of the current line
+  char const* last_;      // newline (or end of text) ending the current line
+  char const* end_;       // end of text
+  char const* block_;     // block whose pending newlines are in 'mask_'
+  std::uint64_t mask_;    // newlines of 'block_' after 'last_'
+  detail::NewlineMask newline_mask_;
+
+  char const* next_newline() noexcept;
+
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = std::string_view;
+  using difference_type = std::ptrdiff_t;
+  using pointer = std::string_view const*;
+  using reference = std::string_view;
+
+  iterator() noexcept;
+  explicit iterator(std::string_view text) noexcept;
+
+  std::string_view operator*() const noexcept;
+  iterator& operator++() noexcept;
+  iterator operator++(int) noexcept;
+
+  // Return the text after the current line.
+  std::string_view rest() const noexcept;
+
+  friend bool operator==(iterator const& it, sentinel) noexcept {
+    return it.first_ == it.end_;
+  }
+  friend bool operator!=(iterator const& it, sentinel s) noexcept {
+    return !(it == s);
+  }
+  friend bool operator==(sentinel s, iterator const& it) noexcept {
+    return it == s;
+  }
+  friend bool operator!=(sentinel s, iterator const& it) noexcept {
+    return !(it == s);
+  }
+};
+
+} // namespace aoc
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+///////////////////////////////////////////////////////////////////////////////
+#include <charconv>    // from_chars
+#include <cstring>     // memchr, memcpy
+#include <type_traits> // is_signed
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+constexpr bool aoc::is_digit(char const c) noexcept {
+  return '0' <= c && c <= '9';
+}
+
+inline std::uint64_t aoc::newline_mask(char const* const block) noexcept {
+  return detail::newline_mask_kernel(block);
+}
+
+inline std::uint64_t aoc::load_chunk(char const* const p) noexcept {
+  std::uint64_t res;
+  std::memcpy(&res, p, sizeof(res));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+  res = __builtin_bswap64(res);
+#endif
+  return res;
+}
+
+constexpr bool aoc::is_eight_digits(std::uint64_t const chunk) noexcept {
+  // Every byte must be 0x3X, and X + 6 must not carry into the high nibble.
+  return ((chunk & 0xf0f0f0f0f0f0f0f0)
+        | (((chunk + 0x0606060606060606) & 0xf0f0f0f0f0f0f0f0) >> 4))
+      == 0x3333333333333333;
+}
+
+constexpr std::uint32_t aoc::parse_eight_digits(std::uint64_t chunk) noexcept {
+  // Combine adjacent digits, then adjacent pairs, then adjacent quadruples.
+  auto constexpr mask = std::uint64_t{0x000000ff000000ff};
+  auto constexpr mul1 = std::uint64_t{100} + (std::uint64_t{1000000} << 32);
+  auto constexpr mul2 = std::uint64_t{1} + (std::uint64_t{10000} << 32);
+  chunk -= 0x3030303030303030;
+  chunk = chunk * 10 + (chunk >> 8);
+  return static_cast<std::uint32_t>(
+    ((chunk & mask) * mul1 + ((chunk >> 16) & mask) * mul2) >> 32);
+}
+
+template <typename Int>
+Int aoc::to_int(std::string_view digits) noexcept {
+  auto negative = false;
+  if constexpr (std::is_signed_v<Int>) {
+    if (!digits.empty() && (digits.front() == '-' || digits.front() == '+')) {
+      negative = digits.front() == '-';
+      digits.remove_prefix(1);
+    }
+  }
+  Int res = 0;
+  std::size_t i = 0;
+  for (; i + 8 <= digits.size(); i += 8) {
+    res = res * 100000000 + static_cast<Int>(parse_eight_digits(load_chunk(digits.data() + i)));
+  }
+  for (; i < digits.size(); ++i) {
+    res = res * 10 + static_cast<Int>(digits[i] - '0');
+  }
+  return negative ? 0 - res : res;
+}
+
+inline void aoc::skip_to_digit(std::string_view& text) noexcept {
+  std::size_t pos = 0;
+  while (pos != text.size() && !is_digit(text[pos])) {
+    ++pos;
+  }
+  text.remove_prefix(pos);
+}
+
+template <typename Int>
+Int aoc::fetch_int(std::string_view& text) noexcept {
+  skip_to_digit(text);
+  Int res = 0;
+  std::size_t pos = 0;
+  for (std::uint64_t chunk;
+       pos + 8 <= text.size() && is_eight_digits(chunk = load_chunk(text.data() + pos));
+       pos += 8) {
+    res = res * 100000000 + static_cast<Int>(parse_eight_digits(chunk));
+  }
+  for (; pos != text.size() && is_digit(text[pos]); ++pos) {
+    res = res * 10 + static_cast<Int>(text[pos] - '0');
+  }
+  text.remove_prefix(pos);
+  return res;
+}
+
+template <typename Int>
+bool aoc::parse_int(std::string_view& text, Int& value) noexcept {
+  auto const last = text.data() + text.size();
+  auto const [p, ec] = std::from_chars(text.data(), last, value);
+  if (ec != std::errc{}) {
+    return false;                                                     // RETURN
+  }
+  text = std::string_view(p, static_cast<std::size_t>(last - p));
+  return true;
+}
+
+inline std::string_view aoc::fetch_line(std::string_view& text) noexcept {
+  auto const newline = static_cast<char const*>(std::memchr(text.data(), '\n', text.size()));
+  if (!newline) {
+    auto const res = text;
+    text = {};
+    return res;                                                       // RETURN
+  }
+  auto const size = static_cast<std::size_t>(newline - text.data());
+  auto const res = text.substr(0, size);
+  text.remove_prefix(size + 1);
+  return res;
+}
+
+inline aoc::Lines::Lines(std::string_view const text) noexcept
+  : text_{text} {
+}
+
+inline aoc::Lines::iterator aoc::Lines::begin() const noexcept {
+  return iterator{text_};
+}
+
+inline aoc::Lines::sentinel aoc::Lines::end() const noexcept {
+  return {};
+}
+
+inline aoc::Lines::iterator::iterator() noexcept
+  : first_{nullptr}, last_{nullptr}, end_{nullptr}, block_{nullptr}, mask_{0},
+    newline_mask_{nullptr} {
+}
+
+inline aoc::Lines::iterator::iterator(std::string_view const text) noexcept
+  : first_{text.data()}, last_{text.data()}, end_{text.data() + text.size()},
+    block_{text.data()}, mask_{0}, newline_mask_{detail::newline_mask_kernel.get()} {
+  if (first_ != end_) {
+    mask_ = text.size() >= 64 ? newline_mask_(block_) : newline_mask(block_, text.size());
+    last_ = next_newline();
+  }
+}
+
+inline char const* aoc::Lines::iterator::next_newline() noexcept {
+  while (mask_ == 0) {
+    block_ += 64;
+    if (block_ >= end_) {
+      return end_;                                                    // RETURN
+    }
+    auto const size = static_cast<std::size_t>(end_ - block_);
+    mask_ = size >= 64 ? newline_mask_(block_) : newline_mask(block_, size);
+  }
+#if defined(_MSC_VER) && !defined(__clang__)
+  unsigned long bit;
+  _BitScanForward64(&bit, mask_);
+#else
+  auto const bit = __builtin_ctzll(mask_);
+#endif
+  mask_ &= mask_ - 1;
+  return block_ + bit;
+}
+
+inline std::string_view aoc::Lines::iterator::operator*() const noexcept {
+  return {first_, static_cast<std::size_t>(last_ - first_)};
+}
+
+inline aoc::Lines::iterator& aoc::Lines::iterator::operator++() noexcept {
+  if (last_ == end_) {
+    first_ = end_;
+    return *this;                                                     // RETURN
+  }
+  first_ = last_ + 1;
+  if (first_ != end_) {
+    last_ = next_newline();
+  }
+  return *this;
+}
+
+inline aoc::Lines::iterator aoc::Lines::iterator::operator++(int) noexcept {
+  auto const res = *this;
+  ++*this;
+  return res;
+}
+
+inline std::string_view aoc::Lines::iterator::rest() const noexcept {
+  auto const next = last_ == end_ ? end_ : last_ + 1;
+  return {next, static_cast<std::size_t>(end_ - next)};
+}
+
+#endif // AOC_PARSE_HEADER_GUARD
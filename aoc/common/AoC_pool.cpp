@@ -0,0 +1,227 @@
+#include "AoC_pool.hpp"
+#include "AoC_alloc.hpp"
+
+#include <algorithm> // max, min
+#include <cstdlib>   // getenv, strtoul
+#include <exception> // exception_ptr, current_exception, rethrow_exception
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace {
+
+// The pool the calling thread works for, if any, and the index of its queue.
+thread_local aoc::ThreadPool const* current_pool = nullptr;
+thread_local std::size_t current_index = 0;
+
+// Calls of 'run_tasks' by the calling thread which shared out their tasks.
+thread_local std::size_t shared_runs = 0;
+
+} // namespace
+
+std::size_t aoc::thread_count() noexcept {
+  static auto const res = [] {
+    if (alloc_stats_enabled) {
+      return std::size_t{1};                                          // RETURN
+    }
+    if (auto const env = std::getenv("AOC_THREADS")) {
+      auto const n = std::strtoul(env, nullptr, 10);
+      if (n > 0) {
+        return static_cast<std::size_t>(n);                           // RETURN
+      }
+    }
+    return std::max<std::size_t>(1, affinity_cpus().size());
+  }();
+  return res;
+}
+
+std::vector<int> aoc::affinity_cpus() {
+  std::vector<int> res;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (std::size_t cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        res.push_back(static_cast<int>(cpu));
+      }
+    }
+    return res;                                                       // RETURN
+  }
+#endif
+  for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); ++cpu) {
+    res.push_back(static_cast<int>(cpu));
+  }
+  return res;
+}
+
+bool aoc::pin_thread(std::span<int const> const cpus) noexcept {
+#ifdef __linux__
+  if (cpus.empty()) {
+    return false;                                                     // RETURN
+  }
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (auto const cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      return false;                                                   // RETURN
+    }
+    CPU_SET(static_cast<std::size_t>(cpu), &set);
+  }
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  static_cast<void>(cpus);
+  return false;
+#endif
+}
+
+aoc::ThreadPool::ThreadPool(std::size_t const threads) {
+  auto const workers = std::max<std::size_t>(threads, 1) - 1;
+  for (std::size_t i = 0; i <= workers; ++i) {
+    queues_.push_back(std::make_unique<Queue>());
+  }
+  for (std::size_t i = 0; i < workers; ++i) {
+    workers_.emplace_back([this, i] { work(i); });
+  }
+}
+
+aoc::ThreadPool::~ThreadPool() {
+  {
+    auto const lock = std::lock_guard{sleep_mutex_};
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& w : workers_) {
+    w.join();
+  }
+}
+
+std::size_t aoc::ThreadPool::size() const noexcept {
+  return workers_.size() + 1;
+}
+
+void aoc::ThreadPool::submit(Task task) {
+  auto const own = current_pool == this ? current_index : queues_.size() - 1;
+  {
+    auto& queue = *queues_[own];
+    auto const lock = std::lock_guard{queue.mutex};
+    queue.tasks.push_back(std::move(task));
+  }
+  {
+    auto const lock = std::lock_guard{sleep_mutex_};
+    queued_.fetch_add(1, std::memory_order_relaxed);
+  }
+  wake_.notify_one();
+}
+
+// Pop the newest task of the queue of the calling thread, or else steal the
+// oldest task of another queue.
+bool aoc::ThreadPool::pop(Task& task) {
+  auto const own = current_pool == this ? current_index : queues_.size() - 1;
+  for (std::size_t k = 0; k < queues_.size(); ++k) {
+    auto& queue = *queues_[(own + k) % queues_.size()];
+    auto const lock = std::lock_guard{queue.mutex};
+    if (queue.tasks.empty()) {
+      continue;
+    }
+    if (k == 0) {
+      task = std::move(queue.tasks.back());
+      queue.tasks.pop_back();
+    }
+    else {
+      task = std::move(queue.tasks.front());
+      queue.tasks.pop_front();
+    }
+    queued_.fetch_sub(1, std::memory_order_relaxed);
+    return true;                                                      // RETURN
+  }
+  return false;
+}
+
+void aoc::ThreadPool::work(std::size_t const index) {
+  current_pool = this;
+  current_index = index;
+  for (Task task;;) {
+    if (pop(task)) {
+      task();
+      task = nullptr;
+      continue;
+    }
+    auto lock = std::unique_lock{sleep_mutex_};
+    wake_.wait(lock, [&] { return stop_ || queued_.load(std::memory_order_relaxed) > 0; });
+    if (stop_ && queued_.load(std::memory_order_relaxed) == 0) {
+      return;                                                         // RETURN
+    }
+  }
+}
+
+bool aoc::ThreadPool::run_pending() {
+  Task task;
+  if (!pop(task)) {
+    return false;                                                     // RETURN
+  }
+  task();
+  return true;
+}
+
+std::size_t aoc::parallel_runs() noexcept {
+  return shared_runs;
+}
+
+aoc::ThreadPool& aoc::thread_pool() {
+  static auto res = ThreadPool{thread_count()};
+  return res;
+}
+
+void aoc::detail::run_tasks(ThreadPool& pool, std::size_t const count,
+                            std::function<void(std::size_t)> const& task) {
+  if (count <= 1 || pool.size() == 1) {
+    for (std::size_t k = 0; k < count; ++k) {
+      task(k);
+    }
+    return;                                                           // RETURN
+  }
+  ++shared_runs;
+  struct Join {
+    std::atomic<std::size_t> remaining;
+    std::mutex mutex;
+    std::exception_ptr error;
+
+    void fail() noexcept {
+      auto const lock = std::lock_guard{mutex};
+      if (!error) {
+        error = std::current_exception();
+      }
+    }
+  } join{count - 1, {}, {}};
+  for (std::size_t k = 1; k < count; ++k) {
+    pool.submit([&join, &task, k] {
+      try {
+        task(k);
+      }
+      catch (...) {
+        join.fail();
+      }
+      join.remaining.fetch_sub(1, std::memory_order_release);
+    });
+  }
+  try {
+    task(0);
+  }
+  catch (...) {
+    join.fail();
+  }
+  while (join.remaining.load(std::memory_order_acquire) > 0) {
+    if (!pool.run_pending()) {
+      std::this_thread::yield();
+    }
+  }
+  if (join.error) {
+    std::rethrow_exception(join.error);
+  }
+}
+
+std::size_t aoc::detail::chunk_count(ThreadPool const& pool, std::size_t const size) noexcept {
+  return pool.size() == 1 ? 1 : std::min(size, 4 * pool.size());
+}
@@ -0,0 +1,172 @@
+#ifndef AOC_POOL_HEADER_GUARD
+#define AOC_POOL_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_pool.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Work-stealing thread pool shared by the solvers, and parallel algorithms
+// running on it. Every worker has its own deque of tasks: it pushes the tasks
+// it submits to the back of its deque and pops them from there, while idle
+// workers steal from the front of the others' deques. The threads waiting for
+// tasks, the callers of the algorithms below included, run pending tasks
+// meanwhile, so that the algorithms may be nested.
+//
+//   aoc::parallel_invoke(
+//     [&] { res1 = part_1(data); },
+//     [&] { res2 = part_2(data); });
+//
+// The shared pool counts 'thread_count()' threads, the caller included: the
+// environment variable 'AOC_THREADS', if set to a positive number, and else
+// the CPUs the process may run on. With a single thread, everything runs on the caller.
+// With allocation statistics (see AoC_alloc.hpp), the pool always has a single
+// thread, so that every phase and 'NoAllocation' scope counts its own work.
+#include <atomic>             // atomic
+#include <condition_variable> // condition_variable
+#include <cstddef>            // size_t
+#include <deque>              // deque
+#include <functional>         // function
+#include <memory>             // unique_ptr
+#include <mutex>              // mutex
+#include <span>               // span
+#include <thread>             // thread
+#include <utility>            // move, ref
+#include <vector>             // vector
+
+namespace aoc {
+
+// Return the number of threads the solvers may use.
+std::size_t thread_count() noexcept;
+
+// Return the CPUs the calling thread may run on, in increasing order.
+std::vector<int> affinity_cpus();
+
+// Pin the calling thread, and the processes it spawns from then on, to the
+// CPUs 'cpus', and return whether it could be.
+bool pin_thread(std::span<int const> cpus) noexcept;
+
+class ThreadPool {
+public:
+  using Task = std::function<void()>;
+
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+  };
+
+  // One queue per worker, and a last one for the tasks submitted by the other
+  // threads.
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<std::size_t> queued_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  bool stop_ = false;
+
+  void work(std::size_t index);
+  bool pop(Task& task);
+
+public:
+  // Create a pool of 'threads' threads, the threads waiting on it included:
+  // 'threads - 1' workers are started.
+  explicit ThreadPool(std::size_t threads);
+  ThreadPool(ThreadPool const&) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+  ~ThreadPool();
+
+  // Return the number of threads of the pool, the one waiting included.
+  std::size_t size() const noexcept;
+
+  // Queue 'task' to be run by any thread of the pool.
+  void submit(Task task);
+
+  // Run a pending task on the calling thread, if any, and return whether one
+  // was run.
+  bool run_pending();
+};
+
+// Return the pool shared by the solvers, of 'thread_count()' threads, created
+// on first use.
+ThreadPool& thread_pool();
+
+// Return the number of times the calling thread has shared out the tasks of
+// one of the algorithms below with the other threads of the pool, running the
+// pending tasks of any caller while waiting for them.
+std::size_t parallel_runs() noexcept;
+
+// Call 'f(i)' for every 'i' in [first, last), an integral range, in parallel.
+template <typename Index, typename Function>
+void parallel_for(Index first, Index last, Function const& f);
+
+// Return 'identity' combined by 'reduce' with 'map(i)' for every 'i' in
+// [first, last), an integral range, evaluated in parallel. 'reduce' must be
+// associative; the values are combined in order.
+template <typename Index, typename T, typename Map, typename Reduce>
+T parallel_reduce(Index first, Index last, T identity, Map const& map, Reduce const& reduce);
+
+// Call each of 'functions' in parallel, and return once all have returned.
+template <typename... Functions>
+void parallel_invoke(Functions&&... functions);
+
+namespace detail {
+
+// Call 'task(k)' for every 'k' in [0, count) on 'pool', the calling thread
+// taking part, and return once all have returned; rethrow the first exception
+// thrown by any of them.
+void run_tasks(ThreadPool& pool, std::size_t count, std::function<void(std::size_t)> const& task);
+
+// Return the number of chunks to split 'size' items into for 'pool'.
+std::size_t chunk_count(ThreadPool const& pool, std::size_t size) noexcept;
+
+} // namespace detail
+} // namespace aoc
+
+///////////////////////////////////////////////////////////////////////////////
+// Template definitions
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename Index, typename Function>
+void aoc::parallel_for(Index const first, Index const last, Function const& f) {
+  if (!(first < last)) {
+    return;                                                           // RETURN
+  }
+  auto& pool = thread_pool();
+  auto const size = static_cast<std::size_t>(last - first);
+  auto const chunks = detail::chunk_count(pool, size);
+  detail::run_tasks(pool, chunks, [&](std::size_t const k) {
+    auto const end = first + static_cast<Index>(size * (k + 1) / chunks);
+    for (auto i = first + static_cast<Index>(size * k / chunks); i < end; ++i) {
+      f(i);
+    }
+  });
+}
+
+template <typename Index, typename T, typename Map, typename Reduce>
+T aoc::parallel_reduce(Index const first, Index const last, T identity, Map const& map, Reduce const& reduce) {
+  if (!(first < last)) {
+    return identity;                                                  // RETURN
+  }
+  auto& pool = thread_pool();
+  auto const size = static_cast<std::size_t>(last - first);
+  auto const chunks = detail::chunk_count(pool, size);
+  std::vector<T> partial(chunks, identity);
+  detail::run_tasks(pool, chunks, [&](std::size_t const k) {
+    auto const end = first + static_cast<Index>(size * (k + 1) / chunks);
+    for (auto i = first + static_cast<Index>(size * k / chunks); i < end; ++i) {
+      partial[k] = reduce(std::move(partial[k]), map(i));
+    }
+  });
+  for (auto& p : partial) {
+    identity = reduce(std::move(identity), std::move(p));
+  }
+  return identity;
+}
+
+template <typename... Functions>
+void aoc::parallel_invoke(Functions&&... functions) {
+  std::function<void()> const tasks[] = {std::function<void()>{std::ref(functions)}...};
+  detail::run_tasks(thread_pool(), sizeof...(Functions), [&](std::size_t const k) {
+    tasks[k]();
+  });
+}
+
+#endif // AOC_POOL_HEADER_GUARD
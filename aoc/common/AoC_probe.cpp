@@ -0,0 +1,369 @@
+#include "AoC_probe.hpp"
+#include "AoC_parse.hpp"
+#include "AoC_pool.hpp"
+
+#include <array>    // array
+#include <cstdlib>  // getenv
+#include <iterator> // size
+#include <mutex>    // mutex, lock_guard
+#include <string>   // stod
+#include <utility>  // move
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#else
+#include <chrono> // steady_clock
+#endif
+
+namespace {
+
+auto constexpr counter_count = std::size_t{4};
+
+// Group of hardware counters of the calling thread, opened on first use. The
+// counters the kernel refuses, e.g. for lack of permission ('perf_event_paranoid')
+// or of hardware (virtual machines), are missing.
+class Counters {
+  std::array<int, counter_count> fds_;
+  int leader_ = -1;
+  std::size_t members_ = 0;
+
+public:
+  Counters() noexcept {
+    fds_.fill(-1);
+#ifdef __linux__
+    constexpr std::array<std::uint64_t, counter_count> events = {
+      PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+      PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+    };
+    for (std::size_t i = 0; i < counter_count; ++i) {
+      perf_event_attr attr{};
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = events[i];
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+                       | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      auto const fd = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, leader_, 0));
+      if (fd < 0) {
+        continue;
+      }
+      if (leader_ < 0) {
+        leader_ = fd;
+      }
+      fds_[i] = fd;
+      ++members_;
+    }
+    if (leader_ >= 0) {
+      ioctl(leader_, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+#endif
+  }
+
+  Counters(Counters const&) = delete;
+  Counters& operator=(Counters const&) = delete;
+
+  ~Counters() {
+#ifdef __linux__
+    for (auto const fd : fds_) {
+      if (fd >= 0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+  // Store the current values of the counters into 'res', scaled up if the
+  // group was not always scheduled on the processor.
+  void read(std::optional<std::uint64_t> (&res)[counter_count]) const noexcept {
+#ifdef __linux__
+    if (leader_ < 0) {
+      return;                                                         // RETURN
+    }
+    // nr, time_enabled, time_running, then one value per member
+    std::array<std::uint64_t, 3 + counter_count> buf{};
+    auto const size = static_cast<long>(sizeof(std::uint64_t) * (3 + members_));
+    if (::read(leader_, buf.data(), sizeof(buf)) != size || buf[0] != members_) {
+      return;                                                         // RETURN
+    }
+    auto const scale = buf[2] == 0 || buf[2] == buf[1]
+      ? 1.0 : static_cast<double>(buf[1]) / static_cast<double>(buf[2]);
+    std::size_t member = 0;
+    for (std::size_t i = 0; i < counter_count; ++i) {
+      if (fds_[i] >= 0) {
+        res[i] = static_cast<std::uint64_t>(static_cast<double>(buf[3 + member++]) * scale);
+      }
+    }
+#else
+    static_cast<void>(res);
+#endif
+  }
+};
+
+// Phases recorded by the program, reported at exit if 'AOC_PROBE' is set.
+class Registry {
+  std::mutex mutex_;
+  std::vector<aoc::ProbeRecord> records_;
+
+public:
+  void add(aoc::ProbeRecord record) {
+    auto const lock = std::lock_guard{mutex_};
+    records_.push_back(std::move(record));
+  }
+
+  std::vector<aoc::ProbeRecord> records() {
+    auto const lock = std::lock_guard{mutex_};
+    return records_;
+  }
+
+  ~Registry() {
+    auto const name = std::getenv("AOC_PROBE");
+    if (!name || records_.empty()) {
+      return;                                                         // RETURN
+    }
+    auto const format = aoc::parse_probe_format(name);
+    if (!format) {
+      std::fprintf(stderr, "AOC_PROBE: unknown format '%s', ignored\n", name);
+      return;                                                         // RETURN
+    }
+    auto out = stderr;
+    if (auto const path = std::getenv("AOC_PROBE_OUTPUT")) {
+      out = std::fopen(path, "w");
+      if (!out) {
+        std::fprintf(stderr, "AOC_PROBE_OUTPUT: cannot open '%s'\n", path);
+        return;                                                       // RETURN
+      }
+    }
+    aoc::write_probes(out, *format, records_);
+    if (out != stderr) {
+      std::fclose(out);
+    }
+  }
+};
+
+Registry& registry() {
+  static auto res = Registry{};
+  return res;
+}
+
+// Optional measures, in the order of the reports; the hardware counters come
+// first, in the order of 'Counters'.
+struct Field {
+  char const* name;  // in 'json' and 'csv'
+  char const* title; // in 'text'
+  int width;
+  std::optional<std::uint64_t> aoc::Measure::* member;
+};
+
+constexpr Field fields[] = {
+  {"cycles", "cycles", 14, &aoc::Measure::cycles},
+  {"instructions", "instructions", 14, &aoc::Measure::instructions},
+  {"cache_misses", "cache miss", 12, &aoc::Measure::cache_misses},
+  {"branch_misses", "branch miss", 12, &aoc::Measure::branch_misses},
+  {"allocations", "allocs", 10, &aoc::Measure::allocations},
+  {"allocated_bytes", "alloc bytes", 12, &aoc::Measure::allocated_bytes},
+  {"peak_bytes", "peak bytes", 12, &aoc::Measure::peak_bytes},
+};
+
+// Write 'value', or the text for a missing value.
+void put(std::FILE* const out, std::optional<std::uint64_t> const value,
+         char const* const missing, int const width = 0) {
+  if (value) {
+    std::fprintf(out, "%*llu", width, static_cast<unsigned long long>(*value));
+  }
+  else {
+    std::fprintf(out, "%*s", width, missing);
+  }
+}
+
+// Return the first field of the comma-separated 'line', and remove it.
+std::string_view fetch_field(std::string_view& line) noexcept {
+  auto const comma = line.find(',');
+  auto const res = line.substr(0, comma);
+  line.remove_prefix(comma == std::string_view::npos ? line.size() : comma + 1);
+  return res;
+}
+
+} // namespace
+
+std::optional<aoc::ProbeFormat> aoc::parse_probe_format(std::string_view const name) noexcept {
+  if (name == "text") return ProbeFormat::text;                       // RETURN
+  if (name == "json") return ProbeFormat::json;                       // RETURN
+  if (name == "csv") return ProbeFormat::csv;                         // RETURN
+  return std::nullopt;
+}
+
+aoc::Probe::Snapshot aoc::Probe::snapshot() noexcept {
+  Snapshot res;
+  res.heap = alloc_stats();
+  thread_local auto const counters = Counters{};
+  counters.read(res.counters);
+  res.parallel_runs = parallel_runs();
+#ifdef __linux__
+  timespec now{};
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  res.nanoseconds = static_cast<std::uint64_t>(now.tv_sec) * 1'000'000'000
+                  + static_cast<std::uint64_t>(now.tv_nsec);
+#else
+  res.nanoseconds = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+  return res;
+}
+
+aoc::Probe::Probe(std::string_view const phase)
+  : phase_{phase} {
+  registry(); // constructed before, thus destroyed after, the probe
+  reset_alloc_peak();
+  start_ = snapshot();
+  running_ = true;
+}
+
+aoc::Probe::~Probe() {
+  stop();
+}
+
+void aoc::Probe::next(std::string_view const phase) {
+  stop();
+  phase_ = phase;
+  reset_alloc_peak();
+  start_ = snapshot();
+  running_ = true;
+}
+
+void aoc::Probe::stop() {
+  if (!running_) {
+    return;                                                           // RETURN
+  }
+  auto const end = snapshot();
+  running_ = false;
+  auto record = ProbeRecord{{}, std::move(phase_), {}};
+  record.measure.seconds = static_cast<double>(end.nanoseconds - start_.nanoseconds) * 1e-9;
+  if (end.parallel_runs == start_.parallel_runs) { // else the phase spread over other threads
+    for (std::size_t i = 0; i < counter_count; ++i) {
+      if (start_.counters[i] && end.counters[i]) {
+        record.measure.*fields[i].member = *end.counters[i] - *start_.counters[i];
+      }
+    }
+  }
+  if (alloc_stats_enabled) {
+    record.measure.allocations = end.heap.allocations - start_.heap.allocations;
+    record.measure.allocated_bytes = end.heap.bytes - start_.heap.bytes;
+    record.measure.peak_bytes = end.heap.peak;
+  }
+  registry().add(std::move(record));
+}
+
+std::vector<aoc::ProbeRecord> aoc::probe_records() {
+  return registry().records();
+}
+
+void aoc::detail::put_json(std::FILE* const out, std::string_view const text) {
+  std::fputc('"', out);
+  for (auto const c : text) {
+    if (c == '"' || c == '\\') {
+      std::fputc('\\', out);
+      std::fputc(c, out);
+    }
+    else if (static_cast<unsigned char>(c) < 0x20) { // control characters
+      std::fprintf(out, "\\u%04x", static_cast<unsigned>(c));
+    }
+    else {
+      std::fputc(c, out);
+    }
+  }
+  std::fputc('"', out);
+}
+
+void aoc::write_probes(std::FILE* const out, ProbeFormat const format,
+                       std::span<ProbeRecord const> const records) {
+  switch (format) {
+  case ProbeFormat::text:
+    std::fprintf(out, "%-8s %-8s %12s", "puzzle", "phase", "time [ms]");
+    for (auto const& f : fields) {
+      std::fprintf(out, " %*s", f.width, f.title);
+      if (f.member == &Measure::instructions) {
+        std::fprintf(out, " %6s", "IPC");
+      }
+    }
+    std::fputc('\n', out);
+    for (auto const& r : records) {
+      auto const& m = r.measure;
+      std::fprintf(out, "%-8s %-8s %12.3f", r.puzzle.c_str(), r.phase.c_str(), m.seconds * 1e3);
+      for (auto const& f : fields) {
+        std::fputc(' ', out);
+        put(out, m.*f.member, "-", f.width);
+        if (f.member != &Measure::instructions) {
+          continue;
+        }
+        if (m.cycles && m.instructions && *m.cycles != 0) {
+          std::fprintf(out, " %6.2f", static_cast<double>(*m.instructions) / static_cast<double>(*m.cycles));
+        }
+        else {
+          std::fprintf(out, " %6s", "-");
+        }
+      }
+      std::fputc('\n', out);
+    }
+    break;
+  case ProbeFormat::json:
+    std::fputs("[", out);
+    for (std::size_t i = 0; i < records.size(); ++i) {
+      auto const& r = records[i];
+      std::fputs(i == 0 ? "\n  {\"puzzle\": " : ",\n  {\"puzzle\": ", out);
+      detail::put_json(out, r.puzzle);
+      std::fputs(", \"phase\": ", out);
+      detail::put_json(out, r.phase);
+      std::fprintf(out, ", \"seconds\": %.9f", r.measure.seconds);
+      for (auto const& f : fields) {
+        std::fprintf(out, ", \"%s\": ", f.name);
+        put(out, r.measure.*f.member, "null");
+      }
+      std::fputs("}", out);
+    }
+    std::fputs("\n]\n", out);
+    break;
+  case ProbeFormat::csv:
+    std::fputs("puzzle,phase,seconds", out);
+    for (auto const& f : fields) {
+      std::fprintf(out, ",%s", f.name);
+    }
+    std::fputc('\n', out);
+    for (auto const& r : records) {
+      std::fprintf(out, "%s,%s,%.9f", r.puzzle.c_str(), r.phase.c_str(), r.measure.seconds);
+      for (auto const& f : fields) {
+        std::fputc(',', out);
+        put(out, r.measure.*f.member, "");
+      }
+      std::fputc('\n', out);
+    }
+    break;
+  }
+}
+
+std::vector<aoc::ProbeRecord> aoc::read_probes(std::string_view const text) {
+  std::vector<ProbeRecord> res;
+  for (auto line : Lines{text}) {
+    std::array<std::string_view, 3 + std::size(fields)> values;
+    std::size_t n = 0;
+    for (; n < values.size() && !line.empty(); ++n) {
+      values[n] = fetch_field(line);
+    }
+    if (n < 3 || values[2].empty() || !is_digit(values[2].front())) {
+      continue; // header or garbage
+    }
+    auto record = ProbeRecord{std::string{values[0]}, std::string{values[1]}, {}};
+    record.measure.seconds = std::stod(std::string{values[2]});
+    for (std::size_t i = 0; 3 + i < n; ++i) {
+      if (!values[3 + i].empty()) {
+        record.measure.*fields[i].member = to_int<std::uint64_t>(values[3 + i]);
+      }
+    }
+    res.push_back(std::move(record));
+  }
+  return res;
+}
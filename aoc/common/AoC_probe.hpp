@@ -0,0 +1,113 @@
+#ifndef AOC_PROBE_HEADER_GUARD
+#define AOC_PROBE_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_probe.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Measurement of the phases of a solver (parsing, part 1, part 2): the time
+// taken and, where the kernel grants access to the hardware performance
+// counters ('perf_event_open'), the cycles, instructions, cache misses and
+// branch misses of the measuring thread. A phase sharing out its work with the
+// thread pool (see AoC_pool.hpp) has its counters missing, since its tasks run
+// on other threads while the measuring one runs the tasks of any other phase.
+// Without counters, only the time is measured, with 'clock_gettime'. With
+// allocation statistics (see AoC_alloc.hpp), the heap traffic of every phase
+// is measured as well: the pool then has a single thread, so that the phases
+// do not count each other's.
+//
+// The phases measured by a program are reported when it exits if the
+// environment variable 'AOC_PROBE' names a format, 'text', 'json' or 'csv',
+// into the file named by 'AOC_PROBE_OUTPUT' or else to the standard error.
+#include <cstddef>     // size_t
+#include <cstdint>     // uint64_t
+#include <cstdio>      // FILE
+#include <optional>    // optional
+#include <span>        // span
+#include <string>      // string
+#include <string_view> // string_view
+#include <vector>      // vector
+
+#include "AoC_alloc.hpp"
+
+namespace aoc {
+
+// Measures of one phase; the counters not available are missing.
+struct Measure {
+  double seconds = 0;
+  std::optional<std::uint64_t> cycles;
+  std::optional<std::uint64_t> instructions;
+  std::optional<std::uint64_t> cache_misses;
+  std::optional<std::uint64_t> branch_misses;
+  std::optional<std::uint64_t> allocations;
+  std::optional<std::uint64_t> allocated_bytes;
+  std::optional<std::uint64_t> peak_bytes; // highest bytes live during the phase
+};
+
+// Measures of the phase 'phase' of the puzzle 'puzzle', e.g. "2020/11"; the
+// puzzle is empty when measured by the puzzle itself.
+struct ProbeRecord {
+  std::string puzzle;
+  std::string phase;
+  Measure measure;
+};
+
+enum class ProbeFormat { text, json, csv };
+
+// Return the format named 'name', if any.
+std::optional<ProbeFormat> parse_probe_format(std::string_view name) noexcept;
+
+// Scoped measure of a sequence of phases of the calling thread: the current
+// phase, started by the constructor or by 'next', is recorded by 'next',
+// 'stop' or the destructor, whichever comes first.
+//
+//   auto probe = aoc::Probe{"parse"};
+//   auto const data = parse(input);
+//   probe.next("part 1");
+//   ...
+class Probe {
+  struct Snapshot {
+    std::uint64_t nanoseconds = 0;
+    std::optional<std::uint64_t> counters[4];
+    std::size_t parallel_runs = 0;
+    AllocStats heap;
+  };
+
+  std::string phase_;
+  Snapshot start_;
+  bool running_ = false;
+
+  static Snapshot snapshot() noexcept;
+
+public:
+  explicit Probe(std::string_view phase);
+  Probe(Probe const&) = delete;
+  Probe& operator=(Probe const&) = delete;
+  ~Probe();
+
+  // Record the current phase and start measuring 'phase'.
+  void next(std::string_view phase);
+
+  // Record the current phase, if any.
+  void stop();
+};
+
+// Return the phases recorded so far by the program, in order of completion.
+std::vector<ProbeRecord> probe_records();
+
+// Write 'records' to 'out' in 'format'. The 'csv' format starts with a line of
+// headers, and leaves the missing counters empty; 'json' writes an array of
+// objects, with 'null' counters when missing.
+void write_probes(std::FILE* out, ProbeFormat format, std::span<ProbeRecord const> records);
+
+// Return the records read from 'text', written in the 'csv' format. The lines
+// which cannot be read are skipped.
+std::vector<ProbeRecord> read_probes(std::string_view text);
+
+namespace detail {
+
+// Write 'text' to 'out' as a JSON string, quotes included.
+void put_json(std::FILE* out, std::string_view text);
+
+} // namespace detail
+} // namespace aoc
+
+#endif // AOC_PROBE_HEADER_GUARD
@@ -0,0 +1,206 @@
+#include "AoC_scaling.hpp"
+
+#include <algorithm> // find_if, max, min_element
+#include <array>     // array
+#include <cmath>     // log, log2, sqrt
+#include <limits>    // numeric_limits
+
+namespace {
+
+constexpr std::array complexities = {
+  aoc::Complexity::constant, aoc::Complexity::linear, aoc::Complexity::n_log_n,
+  aoc::Complexity::quadratic, aoc::Complexity::cubic,
+};
+
+// Return the units of 'complexity' at scale 'n'.
+double units(aoc::Complexity const complexity, double const n) noexcept {
+  switch (complexity) {
+  case aoc::Complexity::constant: return 1;                           // RETURN
+  case aoc::Complexity::linear: return n;                             // RETURN
+  case aoc::Complexity::n_log_n: return n * std::log2(std::max(n, 2.0)); // RETURN
+  case aoc::Complexity::quadratic: return n * n;                      // RETURN
+  case aoc::Complexity::cubic: return n * n * n;                      // RETURN
+  }
+  return 0;
+}
+
+// Return the fit of 'samples' to 'overhead + coefficient * units', by least
+// squares of the relative residuals, both terms being non-negative; the
+// coefficient of 'constant' is 0.
+aoc::ComplexityFit fit(std::span<aoc::ScalingSample const> const samples, aoc::Complexity const complexity) {
+  double sw = 0, swf = 0, swff = 0, swt = 0, swft = 0;
+  for (auto const& s : samples) {
+    auto const f = units(complexity, static_cast<double>(s.scale));
+    auto const w = 1 / (s.seconds * s.seconds);
+    sw += w;
+    swf += w * f;
+    swff += w * f * f;
+    swt += w * s.seconds;
+    swft += w * f * s.seconds;
+  }
+  auto res = aoc::ComplexityFit{complexity, swt / sw, 0, 0, 0};
+  if (complexity != aoc::Complexity::constant) {
+    auto const det = sw * swff - swf * swf;
+    auto const overhead = det > 0 ? (swt * swff - swf * swft) / det : -1;
+    if (overhead >= 0) {
+      res.overhead = overhead;
+      res.coefficient = (sw * swft - swf * swt) / det;
+    }
+    else {
+      res.overhead = 0;
+      res.coefficient = swft / swff;
+    }
+    if (res.coefficient < 0) {
+      res.error = std::numeric_limits<double>::infinity(); // not growing
+      return res;                                                     // RETURN
+    }
+  }
+  double squares = 0;
+  for (auto const& s : samples) {
+    auto const r = (res.overhead + res.coefficient * units(complexity, static_cast<double>(s.scale)) - s.seconds) / s.seconds;
+    squares += r * r;
+  }
+  res.error = std::sqrt(squares / static_cast<double>(samples.size()));
+  return res;
+}
+
+// Return the slope of 'log(seconds)' on 'log(scale)' over 'samples'.
+double exponent(std::span<aoc::ScalingSample const> const samples) noexcept {
+  double sx = 0, sy = 0, sxx = 0, sxy = 0;
+  for (auto const& s : samples) {
+    auto const x = std::log(static_cast<double>(s.scale));
+    auto const y = std::log(s.seconds);
+    sx += x;
+    sy += y;
+    sxx += x * x;
+    sxy += x * y;
+  }
+  auto const n = static_cast<double>(samples.size());
+  auto const det = n * sxx - sx * sx;
+  return det > 0 ? (n * sxy - sx * sy) / det : 0;
+}
+
+} // namespace
+
+std::string_view aoc::complexity_name(Complexity const complexity) noexcept {
+  switch (complexity) {
+  case Complexity::constant: return "O(1)";                           // RETURN
+  case Complexity::linear: return "O(n)";                             // RETURN
+  case Complexity::n_log_n: return "O(n log n)";                      // RETURN
+  case Complexity::quadratic: return "O(n^2)";                        // RETURN
+  case Complexity::cubic: return "O(n^3)";                            // RETURN
+  }
+  return "?";
+}
+
+double aoc::complexity_exponent(Complexity const complexity) noexcept {
+  switch (complexity) {
+  case Complexity::constant: return 0;                                // RETURN
+  case Complexity::linear: return 1;                                  // RETURN
+  case Complexity::n_log_n: return 1.1;                               // RETURN
+  case Complexity::quadratic: return 2;                               // RETURN
+  case Complexity::cubic: return 3;                                   // RETURN
+  }
+  return 0;
+}
+
+std::optional<aoc::ComplexityFit> aoc::fit_complexity(std::span<ScalingSample const> const samples) {
+  std::vector<ScalingSample> fitted;
+  for (auto const& s : samples) {
+    if (s.seconds >= min_fitted_seconds) {
+      fitted.push_back(s);
+    }
+  }
+  if (fitted.size() < 3) {
+    return std::nullopt;                                              // RETURN
+  }
+  std::array<ComplexityFit, complexities.size()> fits;
+  for (std::size_t i = 0; i < complexities.size(); ++i) {
+    fits[i] = fit(fitted, complexities[i]);
+  }
+  auto const best = std::min_element(begin(fits), end(fits), [](auto const& lhs, auto const& rhs) {
+    return lhs.error < rhs.error;
+  })->error;
+  // The simplest class within a quarter, plus 2%, of the best error: a class
+  // higher than needed always fits the noise a little better.
+  auto res = *std::find_if(begin(fits), end(fits), [&](auto const& f) {
+    return f.error <= 1.25 * best + 0.02;
+  });
+  res.exponent = exponent(std::span{fitted}.subspan(fitted.size() / 2));
+  return res;
+}
+
+bool aoc::ScalingReport::exceeds() const noexcept {
+  return fit && fit->exponent > complexity_exponent(bound) + exponent_tolerance;
+}
+
+void aoc::write_scaling(std::FILE* const out, ProbeFormat const format,
+                        std::span<ScalingReport const> const reports) {
+  auto const name = [](std::optional<ComplexityFit> const& f) {
+    return f ? complexity_name(f->complexity) : std::string_view{"-"};
+  };
+  switch (format) {
+  case ProbeFormat::text:
+    std::fprintf(out, "%-8s %-18s %-11s %-11s %8s %7s %7s %12s %10s\n", "puzzle", "unit", "bound", "fit",
+                 "exponent", "error", "samples", "max scale", "time [ms]");
+    for (auto const& r : reports) {
+      std::fprintf(out, "%-8s %-18s %-11s %-11s", r.puzzle.c_str(), r.unit.c_str(),
+                   complexity_name(r.bound).data(), name(r.fit).data());
+      if (r.fit) {
+        std::fprintf(out, " %8.2f %7.3f", r.fit->exponent, r.fit->error);
+      }
+      else {
+        std::fprintf(out, " %8s %7s", "-", "-");
+      }
+      std::fprintf(out, " %7zu", r.samples.size());
+      if (!r.samples.empty()) {
+        std::fprintf(out, " %12llu %10.3f", static_cast<unsigned long long>(r.samples.back().scale),
+                     r.samples.back().seconds * 1e3);
+      }
+      std::fputs(r.exceeds() ? "  EXCEEDS BOUND\n" : "\n", out);
+    }
+    break;
+  case ProbeFormat::json:
+    std::fputs("[", out);
+    for (std::size_t i = 0; i < reports.size(); ++i) {
+      auto const& r = reports[i];
+      std::fputs(i == 0 ? "\n  {\"puzzle\": " : ",\n  {\"puzzle\": ", out);
+      detail::put_json(out, r.puzzle);
+      std::fputs(", \"unit\": ", out);
+      detail::put_json(out, r.unit);
+      std::fputs(", \"bound\": ", out);
+      detail::put_json(out, complexity_name(r.bound));
+      if (r.fit) {
+        std::fputs(", \"fit\": ", out);
+        detail::put_json(out, complexity_name(r.fit->complexity));
+        std::fprintf(out, ", \"exponent\": %.4f, \"overhead\": %.9g, \"coefficient\": %.9g, \"error\": %.4f",
+                     r.fit->exponent, r.fit->overhead, r.fit->coefficient, r.fit->error);
+      }
+      else {
+        std::fputs(", \"fit\": null, \"exponent\": null, \"overhead\": null, \"coefficient\": null, \"error\": null", out);
+      }
+      std::fprintf(out, ", \"exceeds\": %s,\n   \"samples\": [", r.exceeds() ? "true" : "false");
+      for (std::size_t j = 0; j < r.samples.size(); ++j) {
+        std::fprintf(out, "%s{\"scale\": %llu, \"seconds\": %.9f}", j == 0 ? "" : ", ",
+                     static_cast<unsigned long long>(r.samples[j].scale), r.samples[j].seconds);
+      }
+      std::fputs("]}", out);
+    }
+    std::fputs("\n]\n", out);
+    break;
+  case ProbeFormat::csv:
+    std::fputs("puzzle,unit,bound,fit,exponent,exceeds,scale,seconds\n", out);
+    for (auto const& r : reports) {
+      for (auto const& s : r.samples) {
+        std::fprintf(out, "%s,%s,%s,%s,", r.puzzle.c_str(), r.unit.c_str(),
+                     complexity_name(r.bound).data(), r.fit ? complexity_name(r.fit->complexity).data() : "");
+        if (r.fit) {
+          std::fprintf(out, "%.4f", r.fit->exponent);
+        }
+        std::fprintf(out, ",%d,%llu,%.9f\n", r.exceeds() ? 1 : 0,
+                     static_cast<unsigned long long>(s.scale), s.seconds);
+      }
+    }
+    break;
+  }
+}
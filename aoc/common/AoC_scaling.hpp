@@ -0,0 +1,77 @@
+#ifndef AOC_SCALING_HEADER_GUARD
+#define AOC_SCALING_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_scaling.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Empirical complexity of the solvers: the times a solver takes on inputs of
+// growing scale are fitted to each class of complexity, as an overhead plus a
+// multiple of the class, and the growth measured is compared with the bound
+// the solver is declared to stay within. As the caches overflow, the time per
+// item of a linear solver grows as well, often fitting 'n log n' best: only an
+// exponent clearly above that of the bound exceeds it.
+#include <cstdint>     // uint64_t
+#include <cstdio>      // FILE
+#include <optional>    // optional
+#include <span>        // span
+#include <string>      // string
+#include <string_view> // string_view
+#include <vector>      // vector
+
+#include "AoC_probe.hpp"
+
+namespace aoc {
+
+enum class Complexity { constant, linear, n_log_n, quadratic, cubic };
+
+// Return the name of 'complexity', e.g. "O(n log n)".
+std::string_view complexity_name(Complexity complexity) noexcept;
+
+// Return the exponent of the growth of 'complexity', e.g. 1.1 for 'n_log_n'
+// over the scales measured.
+double complexity_exponent(Complexity complexity) noexcept;
+
+struct ScalingSample {
+  std::uint64_t scale;
+  double seconds;
+};
+
+struct ComplexityFit {
+  Complexity complexity;
+  double overhead;    // seconds, whatever the scale
+  double coefficient; // seconds per unit of 'complexity'
+  double error;       // root mean square of the relative residuals
+  double exponent;    // slope of log(seconds) on log(scale) over the larger half
+};
+
+// Samples faster than this are dominated by noise, and are not fitted.
+inline constexpr double min_fitted_seconds = 1e-3;
+
+// Excess of exponent over that of the bound still within the bound.
+inline constexpr double exponent_tolerance = 0.3;
+
+// Return the class of complexity fitting 'samples' best, the simplest one
+// among those fitting about as well; or nothing if fewer than 3 samples last
+// long enough to be fitted.
+std::optional<ComplexityFit> fit_complexity(std::span<ScalingSample const> samples);
+
+// Scaling of the puzzle 'puzzle', e.g. "2020/10", whose scale counts 'unit'.
+struct ScalingReport {
+  std::string puzzle;
+  std::string unit;
+  Complexity bound;
+  std::vector<ScalingSample> samples; // by increasing scale
+  std::optional<ComplexityFit> fit;
+
+  // Return whether the exponent measured exceeds that of the bound by more
+  // than 'exponent_tolerance'.
+  bool exceeds() const noexcept;
+};
+
+// Write 'reports' to 'out' in 'format'. The 'json' format writes an array of
+// objects, the samples of each in an array; 'csv' writes a line per sample,
+// after a line of headers, repeating the fit of its puzzle.
+void write_scaling(std::FILE* out, ProbeFormat format, std::span<ScalingReport const> reports);
+
+} // namespace aoc
+
+#endif // AOC_SCALING_HEADER_GUARD
@@ -0,0 +1,823 @@
+#include "AoC_gen.hpp"
+
+#include <fmt/core.h>
+#include <fmt/format.h>
+
+#include <algorithm>   // clamp, find, find_if, max, min, sort, unique
+#include <array>       // array
+#include <iterator>    // back_inserter
+#include <numeric>     // iota
+#include <string>      // string
+#include <string_view> // string_view
+#include <utility>     // exchange, forward, pair
+#include <vector>      // erase_if, vector
+
+namespace {
+
+// Buffered writer of the generated text, flushing every 64 KiB so that even
+// the largest inputs are written in constant memory.
+class Output {
+  std::FILE* out_;
+  fmt::memory_buffer buffer_;
+
+public:
+  explicit Output(std::FILE* out) noexcept : out_{out} {
+  }
+  Output(Output const&) = delete;
+  Output& operator=(Output const&) = delete;
+  ~Output() {
+    flush();
+  }
+
+  template <typename... Args>
+  void print(fmt::format_string<Args...> format, Args&&... args) {
+    fmt::format_to(std::back_inserter(buffer_), format, std::forward<Args>(args)...);
+    if (buffer_.size() >= (1 << 16)) {
+      flush();
+    }
+  }
+
+  void flush() noexcept {
+    std::fwrite(buffer_.data(), 1, buffer_.size(), out_);
+    buffer_.clear();
+  }
+};
+
+auto constexpr letters = std::string_view{"abcdefghijklmnopqrstuvwxyz"};
+
+///////////////////////////////////////////////////////////////////////////////
+// 2020
+///////////////////////////////////////////////////////////////////////////////
+
+// Rows of 31 squares, with a tree on about a fifth of them.
+void trees(std::FILE* const f, std::uint64_t const rows, aoc::Random& random) {
+  auto out = Output{f};
+  auto row = std::string(31, '.');
+  for (std::uint64_t r = 0; r < rows; ++r) {
+    for (auto& c : row) {
+      c = random.chance(0.2) ? '#' : '.';
+    }
+    if (r == 0) {
+      row[0] = '.';
+    }
+    out.print("{}\n", row);
+  }
+}
+
+// Passports with fields missing or invalid now and then.
+void passports(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  static auto constexpr colors = std::array{"amb", "blu", "brn", "gry", "grn", "hzl", "oth"};
+  auto out = Output{f};
+  auto const digits = [&](int const count) {
+    auto res = std::string{};
+    for (auto i = 0; i < count; ++i) {
+      res += static_cast<char>('0' + random.below(10));
+    }
+    return res;
+  };
+  auto fields = std::vector<std::string>{};
+  for (std::uint64_t i = 0; i < n; ++i) {
+    auto const valid = random.chance(0.8);
+    auto const value = [&](std::string_view const key) -> std::string {
+      auto const v = valid || random.chance(0.8);
+      if (key == "byr") {
+        return fmt::format("{}", v ? random.between(1920, 2002) : random.between(1900, 1919));
+      }
+      if (key == "iyr") {
+        return fmt::format("{}", v ? random.between(2010, 2020) : random.between(2021, 2030));
+      }
+      if (key == "eyr") {
+        return fmt::format("{}", v ? random.between(2020, 2030) : random.between(2031, 2040));
+      }
+      if (key == "hgt") {
+        if (!v) {
+          return fmt::format("{}", random.between(50, 200));
+        }
+        return random.chance(0.5) ? fmt::format("{}cm", random.between(150, 193))
+          : fmt::format("{}in", random.between(59, 76));
+      }
+      if (key == "hcl") {
+        auto res = std::string{v ? "#" : ""};
+        for (auto k = 0; k < 6; ++k) {
+          res += "0123456789abcdef"[random.below(16)];
+        }
+        return res;
+      }
+      if (key == "ecl") {
+        return v ? colors[random.below(colors.size())] : "xry";
+      }
+      if (key == "pid") {
+        return digits(v ? 9 : 10);
+      }
+      return fmt::format("{}", random.between(50, 350)); // cid
+    };
+    fields.clear();
+    for (auto const key : {"byr", "iyr", "eyr", "hgt", "hcl", "ecl", "pid", "cid"}) {
+      auto const present = std::string_view{key} == "cid" ? random.chance(0.5)
+        : valid || random.chance(0.9);
+      if (present) {
+        fields.push_back(fmt::format("{}:{}", key, value(key)));
+      }
+    }
+    random.shuffle(begin(fields), end(fields));
+    if (i != 0) {
+      out.print("\n");
+    }
+    for (std::size_t k = 0; k < fields.size(); ++k) {
+      out.print("{}{}", fields[k],
+        k + 1 == fields.size() ? '\n' : random.chance(0.25) ? '\n' : ' ');
+    }
+  }
+}
+
+// Boarding passes of all the seats of a contiguous range of ids but one.
+void boarding_passes(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  auto const lo = random.below(1024 - n);
+  auto const missing = lo + 1 + random.below(n - 1);
+  auto ids = std::vector<std::uint64_t>{};
+  for (auto id = lo; id <= lo + n; ++id) {
+    if (id != missing) {
+      ids.push_back(id);
+    }
+  }
+  random.shuffle(begin(ids), end(ids));
+  for (auto const id : ids) {
+    auto pass = std::string(10, ' ');
+    for (std::size_t k = 0; k < 10; ++k) {
+      auto const bit = (id >> (9 - k)) & 1;
+      pass[k] = k < 7 ? (bit ? 'B' : 'F') : (bit ? 'R' : 'L');
+    }
+    out.print("{}\n", pass);
+  }
+}
+
+// Groups of 1 to 5 persons, answering questions the group mostly shares.
+void answers(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  auto common = std::string{};
+  auto line = std::string{};
+  for (std::uint64_t i = 0; i < n; ++i) {
+    if (i != 0) {
+      out.print("\n");
+    }
+    common.clear();
+    for (auto const c : letters) {
+      if (random.chance(0.3)) {
+        common += c;
+      }
+    }
+    for (auto p = random.between(1, 5); p > 0; --p) {
+      line.clear();
+      for (auto const c : letters) {
+        auto const shared = common.find(c) != std::string::npos;
+        if (random.chance(shared ? 0.9 : 0.1)) {
+          line += c;
+        }
+      }
+      if (line.empty()) {
+        line += letters[random.below(letters.size())];
+      }
+      random.shuffle(begin(line), end(line));
+      out.print("{}\n", line);
+    }
+  }
+}
+
+// Return the name of the 'k'-th color, for 'k' below 6400^2: two words of two
+// syllables, neither holding a digit nor spelling "bag", "shiny" or "gold".
+std::string color(std::uint64_t const k) {
+  static auto constexpr consonants = std::string_view{"cdfghjklmnprstvz"};
+  static auto constexpr vowels = std::string_view{"aeiou"};
+  auto const syllables = consonants.size() * vowels.size();
+  auto const words = syllables * syllables;
+  auto res = std::string{};
+  for (auto const w : {k % words, k / words}) {
+    if (!res.empty()) {
+      res += ' ';
+    }
+    for (auto const s : {w % syllables, w / syllables % syllables}) {
+      res += consonants[s % consonants.size()];
+      res += vowels[s / consonants.size()];
+    }
+  }
+  return res;
+}
+
+// Rules of 'n' colors, shiny gold being the second one. The colors contain
+// one bag of each of their children in a random recursive tree rooted at the
+// first color, and up to 5 bags of some of the colors containing nothing, so
+// that the bags in shiny gold grow linearly with 'n'.
+void bags(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  auto const name = [](std::uint64_t const k) {
+    return k == 1 ? std::string{"shiny gold"} : color(k);
+  };
+  auto contents = std::vector<std::vector<std::pair<std::uint64_t, int>>>(n);
+  for (std::uint64_t k = 1; k < n; ++k) {
+    contents[random.below(k)].emplace_back(k, 1);
+  }
+  auto leaves = std::vector<std::uint64_t>{};
+  for (std::uint64_t k = 0; k < n; ++k) {
+    if (contents[k].empty()) {
+      leaves.push_back(k);
+    }
+  }
+  for (auto& c : contents) {
+    if (c.empty()) {
+      continue;
+    }
+    for (auto& [k, count] : c) {
+      if (contents[k].empty()) {
+        count = static_cast<int>(random.between(1, 5));
+      }
+    }
+    for (auto extra = random.below(3); extra > 0; --extra) {
+      auto const leaf = leaves[random.below(leaves.size())];
+      if (std::find_if(begin(c), end(c), [&](auto const& e) { return e.first == leaf; }) == end(c)) {
+        c.emplace_back(leaf, static_cast<int>(random.between(1, 5)));
+      }
+    }
+    random.shuffle(begin(c), end(c));
+  }
+  auto order = std::vector<std::uint64_t>(n);
+  std::iota(begin(order), end(order), std::uint64_t{0});
+  random.shuffle(begin(order), end(order));
+  for (auto const k : order) {
+    out.print("{} bags contain ", name(k));
+    if (contents[k].empty()) {
+      out.print("no other bags.\n");
+      continue;
+    }
+    for (std::size_t i = 0; i < contents[k].size(); ++i) {
+      auto const [child, count] = contents[k][i];
+      out.print("{} {} bag{}{}", count, name(child), count == 1 ? "" : "s",
+        i + 1 == contents[k].size() ? ".\n" : ", ");
+    }
+  }
+}
+
+// Boot code whose only corrupted instruction is a 'jmp' three quarters in,
+// back to an earlier instruction. Every jump before it, and every 'nop' turned
+// into a jump, lands at most on it, so that no other correction terminates.
+void boot_code(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  auto const q = std::max<std::uint64_t>(1, 3 * n / 4);
+  auto const signed_int = [](std::int64_t const v) {
+    return fmt::format("{}{}", v < 0 ? '-' : '+', v < 0 ? -v : v);
+  };
+  for (std::uint64_t i = 0; i < n; ++i) {
+    auto const pos = static_cast<std::int64_t>(i);
+    auto const limit = static_cast<std::int64_t>(i < q ? q : n);
+    if (i == q) {
+      out.print("jmp {}\n", signed_int(-random.between(1, std::min<std::int64_t>(pos, 50))));
+      continue;
+    }
+    auto const kind = random.below(10);
+    if (kind < 4) {
+      out.print("acc {}\n", signed_int(random.between(-50, 50)));
+    } else if (kind < 7) {
+      auto const lo = i < q ? -std::min<std::int64_t>(pos, 50) : -50;
+      out.print("nop {}\n", signed_int(random.between(lo, std::min<std::int64_t>(limit - pos, 50))));
+    } else {
+      out.print("jmp {}\n", signed_int(random.between(1, std::min<std::int64_t>(limit - pos, 5))));
+    }
+  }
+}
+
+// Numbers each the sum of two of the 25 before, up to the last one, the sum
+// of a contiguous range of the first ones. The sums are chosen among the
+// smallest, and the numbers still grow exponentially: 'max_scale' keeps them
+// below 2^31, as the solver adds them as 'int'.
+void xmas(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto constexpr preamble = 25;
+  auto out = Output{f};
+  auto v = std::vector<std::int64_t>{};
+  while (v.size() < preamble) {
+    auto const x = random.between(1, 50);
+    if (std::find(begin(v), end(v), x) == end(v)) {
+      v.push_back(x);
+    }
+  }
+  auto sums = std::vector<std::int64_t>{};
+  while (v.size() + 1 < n) {
+    sums.clear();
+    for (auto i = v.size() - preamble; i < v.size(); ++i) {
+      for (auto j = i + 1; j < v.size(); ++j) {
+        if (v[i] != v[j]) {
+          sums.push_back(v[i] + v[j]);
+        }
+      }
+    }
+    std::sort(begin(sums), end(sums));
+    sums.erase(std::unique(begin(sums), end(sums)), end(sums));
+    auto const window = std::span{v}.last(preamble);
+    std::erase_if(sums, [&](auto const s) {
+      return std::find(begin(window), end(window), s) != end(window);
+    });
+    v.push_back(sums[random.below(std::min<std::size_t>(3, sums.size()))]);
+  }
+  auto const is_sum = [&](std::int64_t const x) {
+    auto const window = std::span{v}.last(preamble);
+    for (auto const a : window) {
+      if (std::find(begin(window), end(window), x - a) != end(window)) {
+        return true;                                                  // RETURN
+      }
+    }
+    return false;
+  };
+  auto invalid = std::int64_t{0};
+  do {
+    auto const first = random.below(v.size() - preamble);
+    auto const length = random.below(5) + 2;
+    invalid = 0;
+    for (auto i = first; i < first + length; ++i) {
+      invalid += v[i];
+    }
+  } while (is_sum(invalid));
+  v.push_back(invalid);
+  for (auto const x : v) {
+    out.print("{}\n", x);
+  }
+}
+
+// Joltages of adapters, runs of 1 to 5 adapters 1 jolt apart separated by
+// gaps of 3 jolts, shuffled. A run of k adapters multiplies the arrangements
+// by 1, 1, 2, 4 or 7 for k from 1 to 5, and the runs are kept short once their
+// product reaches 2^56, so that the count of part 2 fits 64 bits.
+void adapters(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  static auto constexpr arrangements = std::array{1, 1, 1, 2, 4, 7};
+  auto out = Output{f};
+  auto v = std::vector<std::uint32_t>{};
+  v.reserve(n);
+  auto joltage = std::uint32_t{0};
+  auto product = std::uint64_t{1};
+  while (v.size() < n) {
+    auto run = static_cast<std::size_t>(random.between(1, 5));
+    if (product * static_cast<std::uint64_t>(arrangements[run]) >= (std::uint64_t{1} << 56)) {
+      run = 1;
+    }
+    product *= static_cast<std::uint64_t>(arrangements[run]);
+    joltage += 2; // the first adapter of the run is 3 jolts after the last one
+    for (std::size_t k = 0; k < run && v.size() < n; ++k) {
+      v.push_back(++joltage);
+    }
+  }
+  random.shuffle(begin(v), end(v));
+  for (auto const x : v) {
+    out.print("{}\n", x);
+  }
+}
+
+// Return the seats of the square 'layout' still changing once the seats
+// would be settled under the rule of part 1, or of part 2 if 'far'. None
+// means that they settle.
+std::vector<std::size_t> unsettled(std::string const& layout, std::size_t const n, bool const far) {
+  auto constexpr none = ~std::uint32_t{0};
+  auto const side = static_cast<std::ptrdiff_t>(n);
+  auto const threshold = far ? 5 : 4;
+  // The seats each seat sees, in the 8 directions.
+  auto seen = std::vector<std::array<std::uint32_t, 8>>(layout.size());
+  for (std::ptrdiff_t i = 0; i < side; ++i) {
+    for (std::ptrdiff_t j = 0; j < side; ++j) {
+      auto& s = seen[static_cast<std::size_t>(i * side + j)];
+      s.fill(none);
+      auto d = begin(s);
+      for (auto di = -1; di <= 1; ++di) {
+        for (auto dj = -1; dj <= 1; ++dj) {
+          if (di == 0 && dj == 0) {
+            continue;
+          }
+          for (auto k = i + di, l = j + dj; 0 <= k && k < side && 0 <= l && l < side; k += di, l += dj) {
+            auto const index = static_cast<std::size_t>(k * side + l);
+            if (layout[index] != '.') {
+              *d++ = static_cast<std::uint32_t>(index);
+              break;
+            }
+            if (!far) {
+              break;
+            }
+          }
+        }
+      }
+    }
+  }
+  auto state = layout;
+  auto previous = std::string{};
+  auto next = std::string{};
+  for (std::size_t step = 0;; ++step) {
+    next = state;
+    auto changed = false;
+    for (std::size_t k = 0; k < state.size(); ++k) {
+      if (state[k] == '.') {
+        continue;
+      }
+      auto count = 0;
+      for (auto const s : seen[k]) {
+        count += s != none && state[s] == '#';
+      }
+      if ((state[k] == 'L' && count == 0) || (state[k] == '#' && count >= threshold)) {
+        next[k] = state[k] == 'L' ? '#' : 'L';
+        changed = true;
+      }
+    }
+    if (!changed) {
+      return {};                                                      // RETURN
+    }
+    if (next == previous || step > 4 * n + 100) { // cycling
+      auto res = std::vector<std::size_t>{};
+      for (std::size_t k = 0; k < next.size(); ++k) {
+        if (next[k] != state[k]) {
+          res.push_back(k);
+        }
+      }
+      return res;                                                     // RETURN
+    }
+    previous = std::exchange(state, next);
+  }
+}
+
+// Square seat layout, with floor on a seventh of the cells. Random layouts
+// may have regions where the seats never settle, flipping between empty and
+// occupied: a random half of their seats are turned into floor, until the
+// seats settle under both rules. Checking it costs as much as solving.
+void seats(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  auto layout = std::string(n * n, 'L');
+  for (auto& c : layout) {
+    c = random.chance(0.18) ? '.' : 'L';
+  }
+  for (auto settled = false; !settled;) {
+    settled = true;
+    for (auto const far : {false, true}) {
+      auto const cycling = unsettled(layout, n, far);
+      for (auto const k : cycling) {
+        if (k == cycling.front() || random.chance(0.35)) {
+          layout[k] = '.';
+        }
+      }
+      settled = settled && cycling.empty();
+    }
+  }
+  for (std::uint64_t r = 0; r < n; ++r) {
+    out.print("{}\n", std::string_view{layout}.substr(r * n, n));
+  }
+}
+
+// Navigation instructions. The waypoint moves by small steps and rotates
+// often, so that the ship wanders like a random walk and its coordinates stay
+// far from the bounds of 'int'.
+void navigation(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  for (std::uint64_t i = 0; i < n; ++i) {
+    auto const action = "NESWLRF"[random.below(7)];
+    if (action == 'L' || action == 'R') {
+      out.print("{}{}\n", action, 90 * random.between(1, 3));
+    } else {
+      out.print("{}{}\n", action, action == 'F' ? random.between(1, 20) : random.between(1, 5));
+    }
+  }
+}
+
+// Timestamp and 'n' bus slots, most of them out of service. The ids of the
+// buses are distinct primes whose product is below 2^40, so that the alignment
+// of part 2 fits 64 bits.
+void buses(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  auto primes = std::vector<std::uint64_t>{};
+  for (std::uint64_t p = 11; p < 1000; ++p) {
+    auto prime = true;
+    for (std::uint64_t d = 2; d * d <= p; ++d) {
+      prime = prime && p % d != 0;
+    }
+    if (prime) {
+      primes.push_back(p);
+    }
+  }
+  random.shuffle(begin(primes), end(primes));
+  auto ids = std::vector<std::uint64_t>{};
+  auto product = std::uint64_t{1};
+  for (auto const p : primes) {
+    if (ids.size() == n) {
+      break;
+    }
+    if (product * p < (std::uint64_t{1} << 40)) {
+      product *= p;
+      ids.push_back(p);
+    }
+  }
+  auto slots = std::vector<std::uint64_t>(n, 0);
+  for (std::size_t i = 0; i < ids.size(); ++i) {
+    slots[i] = ids[i];
+  }
+  random.shuffle(begin(slots) + 1, end(slots)); // a bus leaves at t
+  out.print("{}\n", random.between(100'000, 1'000'000));
+  for (std::uint64_t i = 0; i < n; ++i) {
+    if (slots[i]) {
+      out.print("{}{}", slots[i], i + 1 == n ? '\n' : ',');
+    } else {
+      out.print("x{}", i + 1 == n ? '\n' : ',');
+    }
+  }
+}
+
+// Masks with at most 6 floating bits, each followed by 1 to 8 writes.
+void docking(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  auto mask = std::string(36, '0');
+  for (std::uint64_t i = 0; i < n;) {
+    for (auto& c : mask) {
+      c = random.chance(0.5) ? '1' : '0';
+    }
+    for (auto x = random.below(7); x > 0; --x) {
+      mask[random.below(mask.size())] = 'X';
+    }
+    out.print("mask = {}\n", mask);
+    for (auto w = random.between(1, 8); w > 0 && i < n; --w, ++i) {
+      out.print("mem[{}] = {}\n", random.below(1 << 16), random.below(std::uint64_t{1} << 36));
+    }
+  }
+}
+
+// Distinct starting numbers, fewer than the 2020 turns of part 1.
+void memory_game(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  auto v = std::vector<std::uint64_t>(4 * n);
+  std::iota(begin(v), end(v), std::uint64_t{0});
+  random.shuffle(begin(v), end(v));
+  for (std::uint64_t i = 0; i < n; ++i) {
+    out.print("{}{}", v[i], i + 1 == n ? '\n' : ',');
+  }
+}
+
+// The 20 fields of the puzzle, whose ranges lie in [25, 974], and 'n' nearby
+// tickets, a fifth of which hold a value in none of the ranges. The columns
+// map to the fields by a hidden permutation, which the valid tickets narrow
+// down.
+void tickets(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  static auto constexpr names = std::array{
+    "departure location", "departure station", "departure platform", "departure track",
+    "departure date", "departure time", "arrival location", "arrival station",
+    "arrival platform", "arrival track", "class", "duration", "price", "route", "row",
+    "seat", "train", "type", "wagon", "zone"};
+  auto out = Output{f};
+  auto ranges = std::array<std::array<std::int64_t, 4>, names.size()>{};
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    auto& [lo1, hi1, lo2, hi2] = ranges[i];
+    lo1 = random.between(25, 250);
+    hi1 = lo1 + random.between(100, 350);
+    lo2 = hi1 + random.between(2, 30);
+    hi2 = random.between(lo2 + 50, 974);
+    out.print("{}: {}-{} or {}-{}\n", names[i], lo1, hi1, lo2, hi2);
+  }
+  auto fields = std::array<std::size_t, names.size()>{};
+  std::iota(begin(fields), end(fields), std::size_t{0});
+  random.shuffle(begin(fields), end(fields));
+  auto const ticket = [&](bool const valid) {
+    auto const wrong = valid ? names.size() : random.below(names.size());
+    for (std::size_t c = 0; c < names.size(); ++c) {
+      auto const& [lo1, hi1, lo2, hi2] = ranges[fields[c]];
+      auto const value = c == wrong ? (random.chance(0.5) ? random.between(0, 24) : random.between(975, 999))
+        : random.chance(0.5) ? random.between(lo1, hi1) : random.between(lo2, hi2);
+      out.print("{}{}", value, c + 1 == names.size() ? '\n' : ',');
+    }
+  };
+  out.print("\nyour ticket:\n");
+  ticket(true);
+  out.print("\nnearby tickets:\n");
+  for (std::uint64_t i = 0; i < n; ++i) {
+    ticket(!random.chance(0.2));
+  }
+}
+
+// Square slice of cubes, half of them active.
+void pocket(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  auto row = std::string(n, '.');
+  for (std::uint64_t r = 0; r < n; ++r) {
+    for (auto& c : row) {
+      c = random.chance(0.5) ? '#' : '.';
+    }
+    out.print("{}\n", row);
+  }
+}
+
+// Write an expression of at most 'budget' numbers, from 1 to 9, and
+// parentheses nested at most 3 deep, so that its value fits 64 bits.
+void expression(Output& out, int& budget, int const depth, aoc::Random& random) {
+  auto const terms = random.between(2, 4);
+  for (auto t = 0; t < terms && budget > 0; ++t) {
+    if (t != 0) {
+      out.print(" {} ", random.chance(0.5) ? '+' : '*');
+    }
+    if (depth < 3 && budget >= 4 && random.chance(0.25)) {
+      out.print("(");
+      expression(out, budget, depth + 1, random);
+      out.print(")");
+    } else {
+      out.print("{}", random.between(1, 9));
+      --budget;
+    }
+  }
+}
+
+// Homework of 'n' expressions of at most 12 numbers.
+void homework(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  for (std::uint64_t i = 0; i < n; ++i) {
+    auto budget = 12;
+    expression(out, budget, 0, random);
+    out.print("\n");
+  }
+}
+
+// Rules where 42 and 31 match words of 8 letters, through 3 levels of rules
+// concatenating 2 rules of the level below, and 'n' messages, most of them
+// words of 42 followed by fewer words of 31, which only the looping rules of
+// part 2 match when not exactly 42 42 31.
+void messages(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  struct Rule {
+    int id;
+    char letter; // terminal rules only
+    std::vector<std::vector<std::size_t>> alternatives; // indices in 'rules'
+  };
+  auto out = Output{f};
+  auto ids = std::vector<int>{};
+  for (auto id = 1; id < 160; ++id) {
+    if (id != 8 && id != 11 && id != 31 && id != 42) {
+      ids.push_back(id);
+    }
+  }
+  random.shuffle(begin(ids), end(ids));
+  auto next_id = begin(ids);
+  auto rules = std::vector<Rule>{{*next_id++, 'a', {}}, {*next_id++, 'b', {}}};
+  auto level = std::vector<std::size_t>{0, 1};
+  for (auto l = 1; l <= 3; ++l) {
+    auto below = level;
+    level.clear();
+    auto const count = l == 3 ? 2 : random.between(2, 4);
+    for (auto k = 0; k < count; ++k) {
+      auto rule = Rule{l == 3 ? (k == 0 ? 42 : 31) : *next_id++, 0, {}};
+      for (auto a = random.chance(0.3) ? 1 : 2; a > 0; --a) {
+        rule.alternatives.push_back({below[random.below(below.size())], below[random.below(below.size())]});
+      }
+      level.push_back(rules.size());
+      rules.push_back(std::move(rule));
+    }
+  }
+  auto lines = std::vector<std::string>{"0: 8 11", "8: 42", "11: 42 31"};
+  for (auto const& rule : rules) {
+    if (rule.letter) {
+      lines.push_back(fmt::format("{}: \"{}\"", rule.id, rule.letter));
+      continue;
+    }
+    auto line = fmt::format("{}:", rule.id);
+    for (std::size_t a = 0; a < rule.alternatives.size(); ++a) {
+      line += a == 0 ? "" : " |";
+      for (auto const r : rule.alternatives[a]) {
+        line += fmt::format(" {}", rules[r].id);
+      }
+    }
+    lines.push_back(std::move(line));
+  }
+  random.shuffle(begin(lines), end(lines));
+  for (auto const& line : lines) {
+    out.print("{}\n", line);
+  }
+  out.print("\n");
+
+  auto message = std::string{};
+  auto const derive = [&](auto const& self, std::size_t const r) -> void {
+    if (rules[r].letter) {
+      message += rules[r].letter;
+      return;
+    }
+    auto const& alternatives = rules[r].alternatives;
+    for (auto const s : alternatives[random.below(alternatives.size())]) {
+      self(self, s);
+    }
+  };
+  auto const r42 = rules.size() - 2;
+  auto const r31 = rules.size() - 1;
+  for (std::uint64_t i = 0; i < n; ++i) {
+    message.clear();
+    auto const kind = random.below(10);
+    if (kind < 3) {
+      for (auto k = 8 * random.between(3, 8); k > 0; --k) {
+        message += random.chance(0.5) ? 'a' : 'b';
+      }
+    } else {
+      auto const k = kind < 6 ? 1 : random.between(1, 4);
+      auto const m = kind < 6 ? 2 : random.between(k + 1, 10 - k);
+      for (auto j = 0; j < m; ++j) {
+        derive(derive, r42);
+      }
+      for (auto j = 0; j < k; ++j) {
+        derive(derive, r31);
+      }
+    }
+    out.print("{}\n", message);
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// 2021
+///////////////////////////////////////////////////////////////////////////////
+
+// Depths of a random walk, going deeper on the whole.
+void depths(std::FILE* const f, std::uint64_t const n, aoc::Random& random) {
+  auto out = Output{f};
+  auto depth = random.between(100, 200);
+  for (std::uint64_t i = 0; i < n; ++i) {
+    out.print("{}\n", depth);
+    depth = std::max<std::int64_t>(0, depth + random.between(-10, 20));
+  }
+}
+
+auto constexpr max = ~std::uint64_t{0};
+
+using C = aoc::Complexity;
+
+// The scale of 2020/11 and 2020/17 is the side of a square, and the seats of
+// 2020/11 settle in a number of rounds growing with it.
+auto constexpr all = std::array{
+  aoc::Generator{2020,  3, "rows", 1, max, C::linear, trees},
+  aoc::Generator{2020,  4, "passports", 1, max, C::linear, passports},
+  aoc::Generator{2020,  5, "boarding passes", 2, 1023, C::n_log_n, boarding_passes},
+  aoc::Generator{2020,  6, "groups", 1, max, C::linear, answers},
+  aoc::Generator{2020,  7, "bag colors", 2, 40'000'000, C::linear, bags},
+  aoc::Generator{2020,  8, "instructions", 2, max, C::quadratic, boot_code},
+  aoc::Generator{2020,  9, "numbers", 40, 600, C::linear, xmas},
+  aoc::Generator{2020, 10, "adapters", 1, 500'000'000, C::n_log_n, adapters},
+  aoc::Generator{2020, 11, "seats per side", 1, 2000, C::cubic, seats},
+  aoc::Generator{2020, 12, "instructions", 1, max, C::linear, navigation},
+  aoc::Generator{2020, 13, "bus slots", 1, max, C::linear, buses},
+  aoc::Generator{2020, 14, "writes", 1, max, C::linear, docking},
+  aoc::Generator{2020, 15, "starting numbers", 1, 2019, C::constant, memory_game},
+  aoc::Generator{2020, 16, "nearby tickets", 1, max, C::linear, tickets},
+  aoc::Generator{2020, 17, "cubes per side", 1, 64, C::quadratic, pocket},
+  aoc::Generator{2020, 18, "expressions", 1, max, C::linear, homework},
+  aoc::Generator{2020, 19, "messages", 1, max, C::linear, messages},
+  aoc::Generator{2021,  1, "depth readings", 1, max, C::linear, depths},
+};
+
+} // namespace
+
+aoc::Random::Random(std::uint64_t seed) noexcept {
+  for (auto& s : state_) { // splitmix64
+    seed += 0x9e3779b97f4a7c15;
+    auto z = seed;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    s = z ^ (z >> 31);
+  }
+}
+
+std::uint64_t aoc::Random::next() noexcept {
+  auto const rotl = [](std::uint64_t const x, int const k) {
+    return (x << k) | (x >> (64 - k));
+  };
+  auto const res = rotl(state_[1] * 5, 7) * 9;
+  auto const t = state_[1] << 17;
+  state_[2] ^= state_[0];
+  state_[3] ^= state_[1];
+  state_[1] ^= state_[2];
+  state_[0] ^= state_[3];
+  state_[2] ^= t;
+  state_[3] = rotl(state_[3], 45);
+  return res;
+}
+
+std::uint64_t aoc::Random::below(std::uint64_t const n) noexcept {
+  auto const threshold = -n % n; // 2^64 mod n, rejected to avoid bias
+  for (;;) {
+    auto const r = next();
+    if (r >= threshold) {
+      return r % n;                                                   // RETURN
+    }
+  }
+}
+
+std::int64_t aoc::Random::between(std::int64_t const lo, std::int64_t const hi) noexcept {
+  return lo + static_cast<std::int64_t>(below(static_cast<std::uint64_t>(hi - lo) + 1));
+}
+
+bool aoc::Random::chance(double const p) noexcept {
+  return static_cast<double>(next() >> 11) * 0x1.0p-53 < p;
+}
+
+std::span<aoc::Generator const> aoc::generators() noexcept {
+  return all;
+}
+
+aoc::Generator const* aoc::find_generator(int const year, int const day) noexcept {
+  auto const it = std::find_if(begin(all), end(all), [&](auto const& g) {
+    return g.year == year && g.day == day;
+  });
+  return it != end(all) ? &*it : nullptr;
+}
+
+void aoc::generate(std::FILE* const out, Generator const& generator, std::uint64_t const scale, std::uint64_t const seed) {
+  auto random = Random{seed};
+  generator.generate(out, std::clamp(scale, generator.min_scale, generator.max_scale), random);
+}
@@ -0,0 +1,84 @@
+#ifndef AOC_GEN_HEADER_GUARD
+#define AOC_GEN_HEADER_GUARD
+///////////////////////////////////////////////////////////////////////////////
+// File AoC_gen.hpp
+///////////////////////////////////////////////////////////////////////////////
+// Generators of synthetic puzzle inputs, at any scale, for the scaling and
+// stress benchmarks. Every input generated is valid: it has the structure the
+// puzzle promises (e.g. exactly one corrupted instruction for 2020/8, a
+// missing seat between two taken ones for 2020/5), so that the solvers run to
+// completion on it. An input depends on its seed and scale only: the
+// pseudo-random numbers are drawn without the distributions of the standard
+// library, whose results vary from one implementation to another.
+#include <cstdint>  // uint64_t
+#include <cstdio>   // FILE
+#include <iterator> // iterator_traits
+#include <span>     // span
+#include <utility>  // swap
+
+#include "AoC_scaling.hpp"
+
+namespace aoc {
+
+// Pseudo-random generator (xoshiro256**, seeded with splitmix64).
+class Random {
+  std::uint64_t state_[4];
+
+public:
+  explicit Random(std::uint64_t seed) noexcept;
+
+  std::uint64_t next() noexcept;
+
+  // Return a number uniformly distributed in [0, n), for n > 0.
+  std::uint64_t below(std::uint64_t n) noexcept;
+
+  // Return a number uniformly distributed in [lo, hi].
+  std::int64_t between(std::int64_t lo, std::int64_t hi) noexcept;
+
+  // Return 'true' with probability 'p'.
+  bool chance(double p) noexcept;
+
+  // Shuffle [first, last) uniformly.
+  template <typename RandomIt>
+  void shuffle(RandomIt first, RandomIt last) noexcept;
+};
+
+// Generator of the inputs of the puzzle 'year'/'day'. The scale counts the
+// items named by 'unit', and is clamped to [min_scale, max_scale], outside of
+// which no valid input exists. The time the solver takes is declared to grow
+// with the scale within 'bound'.
+struct Generator {
+  int year;
+  int day;
+  char const* unit;
+  std::uint64_t min_scale;
+  std::uint64_t max_scale;
+  Complexity bound;
+  void (*generate)(std::FILE* out, std::uint64_t scale, Random& random);
+};
+
+// Return the generators, by year and day.
+std::span<Generator const> generators() noexcept;
+
+// Return the generator of the puzzle 'year'/'day', or null if there is none.
+Generator const* find_generator(int year, int day) noexcept;
+
+// Write to 'out' the input of 'generator' at 'scale', drawn from 'seed'.
+void generate(std::FILE* out, Generator const& generator, std::uint64_t scale, std::uint64_t seed);
+
+} // namespace aoc
+
+///////////////////////////////////////////////////////////////////////////////
+// Template definitions
+///////////////////////////////////////////////////////////////////////////////
+
+template <typename RandomIt>
+void aoc::Random::shuffle(RandomIt const first, RandomIt const last) noexcept {
+  using Difference = typename std::iterator_traits<RandomIt>::difference_type;
+  for (auto i = static_cast<std::uint64_t>(last - first); i > 1; --i) {
+    using std::swap;
+    swap(first[static_cast<Difference>(i - 1)], first[static_cast<Difference>(below(i))]);
+  }
+}
+
+#endif // AOC_GEN_HEADER_GUARD
@@ -0,0 +1,15 @@
+option(ENABLE_ALLOC_STATS "Count the heap allocations of the probed phases" OFF)
+
+# With allocation statistics, 'operator new' and 'operator delete' are
+# replaced by counting ones (see aoc/common/AoC_alloc.hpp), and the probes
+# report the allocations of every phase.
+function(enable_alloc_stats project_name)
+  if(NOT ENABLE_ALLOC_STATS)
+    return()
+  endif()
+  if(ENABLE_SANITIZER_ADDRESS OR ENABLE_SANITIZER_MEMORY)
+    message(WARNING "Allocation statistics replace the allocation functions of the sanitizers")
+  endif()
+  message(STATUS "Allocation statistics enabled")
+  target_compile_definitions(${project_name} INTERFACE AOC_ALLOC_STATS)
+endfunction()
@@ -0,0 +1,125 @@
+option(ENABLE_PGO "Enable profile-guided optimization (see PGO_PHASE)" OFF)
+
+# Profile-guided optimization takes three steps, in the same build directory:
+#   cmake -DENABLE_PGO=ON -DPGO_PHASE=instrument . && cmake --build .
+#   cmake --build . --target pgo-train
+#   cmake -DPGO_PHASE=use . && cmake --build .
+# The training runs every program registered with 'add_pgo_training_run'.
+set(PGO_PHASE
+    "instrument"
+    CACHE STRING "Profile-guided optimization phase")
+set(PGO_PHASE_VALUES "instrument" "use")
+set_property(CACHE PGO_PHASE PROPERTY STRINGS ${PGO_PHASE_VALUES})
+
+set(PGO_PROFILE_DIR
+    "${CMAKE_BINARY_DIR}/pgo"
+    CACHE PATH "Directory of the optimization profiles")
+
+function(enable_pgo project_name)
+  if(NOT ENABLE_PGO)
+    return()
+  endif()
+
+  if(NOT PGO_PHASE IN_LIST PGO_PHASE_VALUES)
+    message(SEND_ERROR "PGO_PHASE must be one of ${PGO_PHASE_VALUES}, not '${PGO_PHASE}'")
+    return()
+  endif()
+
+  if(CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+    if(PGO_PHASE STREQUAL "instrument")
+      # Some puzzles count on several threads at once.
+      set(PGO_FLAGS -fprofile-generate=${PGO_PROFILE_DIR} -fprofile-update=atomic)
+    else()
+      set(PGO_FLAGS -fprofile-use=${PGO_PROFILE_DIR} -Wno-missing-profile)
+      if(CMAKE_CXX_COMPILER_VERSION VERSION_GREATER_EQUAL 10)
+        # Code not run by the training keeps its usual optimizations.
+        list(APPEND PGO_FLAGS -fprofile-partial-training)
+      endif()
+    endif()
+  elseif(CMAKE_CXX_COMPILER_ID MATCHES ".*Clang")
+    if(PGO_PHASE STREQUAL "instrument")
+      set(PGO_FLAGS -fprofile-instr-generate=${PGO_PROFILE_DIR}/raw/%m.profraw)
+    else()
+      set(PGO_FLAGS
+          -fprofile-instr-use=${PGO_PROFILE_DIR}/default.profdata
+          -Wno-profile-instr-unprofiled
+          -Wno-profile-instr-out-of-date)
+    endif()
+  else()
+    message(SEND_ERROR "Profile-guided optimization is not supported for '${CMAKE_CXX_COMPILER_ID}' compiler.")
+    return()
+  endif()
+
+  if(PGO_PHASE STREQUAL "use" AND CMAKE_CXX_COMPILER_ID MATCHES ".*Clang"
+     AND NOT EXISTS ${PGO_PROFILE_DIR}/default.profdata)
+    message(WARNING "No profile in '${PGO_PROFILE_DIR}': build the 'pgo-train' target in the instrument phase first")
+  endif()
+
+  message(STATUS "Profile-guided optimization enabled, phase '${PGO_PHASE}'")
+  target_compile_options(${project_name} INTERFACE ${PGO_FLAGS})
+  target_link_options(${project_name} INTERFACE ${PGO_FLAGS})
+endfunction()
+
+# Register 'target', run with the arguments that follow, as part of the
+# training of the instrumented build.
+function(add_pgo_training_run target)
+  if(NOT ENABLE_PGO)
+    return()
+  endif()
+  # One property per run, so that the arguments of the runs stay apart.
+  get_property(COUNT GLOBAL PROPERTY PGO_TRAINING_RUN_COUNT)
+  if(NOT COUNT)
+    set(COUNT 0)
+  endif()
+  set_property(GLOBAL PROPERTY PGO_TRAINING_RUN_${COUNT} $<TARGET_FILE:${target}> ${ARGN})
+  math(EXPR COUNT "${COUNT} + 1")
+  set_property(GLOBAL PROPERTY PGO_TRAINING_RUN_COUNT ${COUNT})
+  set_property(GLOBAL APPEND PROPERTY PGO_TRAINING_TARGETS ${target})
+endfunction()
+
+# Define the 'pgo-train' target, running all the registered programs and
+# collecting their profiles. Must be called once all of them are defined.
+function(add_pgo_training_target)
+  if(NOT ENABLE_PGO OR NOT PGO_PHASE STREQUAL "instrument")
+    return()
+  endif()
+
+  get_property(COUNT GLOBAL PROPERTY PGO_TRAINING_RUN_COUNT)
+  get_property(TARGETS GLOBAL PROPERTY PGO_TRAINING_TARGETS)
+  if(NOT COUNT)
+    message(WARNING "No training run registered for profile-guided optimization")
+    return()
+  endif()
+
+  set(COMMANDS "")
+  math(EXPR LAST "${COUNT} - 1")
+  foreach(INDEX RANGE ${LAST})
+    get_property(RUN GLOBAL PROPERTY PGO_TRAINING_RUN_${INDEX})
+    list(APPEND COMMANDS COMMAND ${RUN})
+  endforeach()
+
+  if(CMAKE_CXX_COMPILER_ID MATCHES ".*Clang")
+    get_filename_component(COMPILER_DIR ${CMAKE_CXX_COMPILER} DIRECTORY)
+    string(REGEX MATCH "^[0-9]+" COMPILER_MAJOR ${CMAKE_CXX_COMPILER_VERSION})
+    find_program(LLVM_PROFDATA
+                 NAMES llvm-profdata llvm-profdata-${COMPILER_MAJOR}
+                 HINTS ${COMPILER_DIR})
+    if(NOT LLVM_PROFDATA)
+      message(SEND_ERROR "llvm-profdata is required to merge the profiles of Clang")
+      return()
+    endif()
+    list(APPEND COMMANDS COMMAND ${LLVM_PROFDATA} merge -output=${PGO_PROFILE_DIR}/default.profdata
+         ${PGO_PROFILE_DIR}/raw)
+  endif()
+
+  add_custom_target(
+    pgo-train
+    COMMAND ${CMAKE_COMMAND} -E remove_directory ${PGO_PROFILE_DIR}
+    COMMAND ${CMAKE_COMMAND} -E make_directory ${PGO_PROFILE_DIR}/raw
+    ${COMMANDS}
+    DEPENDS ${TARGETS}
+    WORKING_DIRECTORY ${CMAKE_BINARY_DIR}
+    COMMENT "Training the instrumented programs into '${PGO_PROFILE_DIR}'"
+    USES_TERMINAL
+    VERBATIM)
+endfunction()